@@ -0,0 +1,40 @@
+// Box2D user settings, used when Box2D and this project are both built with
+// B2_USER_SETTINGS defined (see BOX2D_ALLOC_HOOKS in CMakeLists.txt).
+// This has to match Box2D's default b2_settings.h except for the allocator,
+// which is routed to our allocation tracking in src/box2dhooks.cpp.
+#ifndef B2_USER_SETTINGS_H
+#define B2_USER_SETTINGS_H
+
+#include <stdarg.h>
+#include <stdint.h>
+
+#define b2_lengthUnitsPerMeter 1.0f
+#define b2_maxPolygonVertices 8
+
+struct B2_API b2BodyUserData {
+    b2BodyUserData() {
+        pointer = 0;
+    }
+    uintptr_t pointer;
+};
+
+struct B2_API b2FixtureUserData {
+    b2FixtureUserData() {
+        pointer = 0;
+    }
+    uintptr_t pointer;
+};
+
+struct B2_API b2JointUserData {
+    b2JointUserData() {
+        pointer = 0;
+    }
+    uintptr_t pointer;
+};
+
+// charged to MEMORY_PHYSICS
+void* b2Alloc(int32 size);
+void b2Free(void* mem);
+void b2Log(const char* string, ...);
+
+#endif
@@ -0,0 +1,12 @@
+#version 330
+
+uniform sampler2D sampler;
+
+in vec2 texCoord;
+in vec4 tint;
+
+out vec4 outColor;
+
+void main() {
+   outColor = texture2D(sampler, texCoord) * tint;
+}
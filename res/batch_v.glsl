@@ -0,0 +1,19 @@
+#version 330
+
+// shared by every program, see frameuniforms.h
+layout(std140) uniform Frame {
+    mat4 viewProjection;
+};
+
+in vec2 position;
+in vec2 texture;
+in vec4 color;
+
+out vec2 texCoord;
+out vec4 tint;
+
+void main() {
+    gl_Position = viewProjection * vec4(position, 0, 1);
+    texCoord = texture;
+    tint = color;
+}
@@ -0,0 +1,24 @@
+#version 330
+
+// shared by every program, see frameuniforms.h
+layout(std140) uniform Frame {
+    mat4 viewProjection;
+};
+// tiles across and down the tile sheet, and where it is in the texture
+uniform vec2 sheetTiles;
+uniform vec4 sheetRegion;
+
+// in cells from the chunk's corner
+in vec2 position;
+// in tiles from the tile sheet's corner
+in vec2 texture;
+
+// per draw, where the chunk's corner is in the world
+in vec2 instanceOffset;
+
+out vec2 texCoord;
+
+void main() {
+    gl_Position = viewProjection * vec4(instanceOffset + position, 0, 1);
+    texCoord = mix(sheetRegion.xy, sheetRegion.zw, texture / sheetTiles);
+}
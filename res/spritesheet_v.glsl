@@ -1,15 +1,24 @@
 #version 330
 
-uniform mat4 matrix;
-uniform vec2 min;
-uniform vec2 max;
+// shared by every program, see frameuniforms.h
+layout(std140) uniform Frame {
+    mat4 viewProjection;
+};
 
 in vec2 position;
 in vec2 texture;
 
+// per instance
+in vec2 instanceOffset;
+in vec2 instanceScale;
+in vec4 instanceFrame;
+in vec4 instanceColor;
+
 out vec2 texCoord;
+out vec4 tint;
 
 void main() {
-    gl_Position = matrix * vec4(position, 0, 1);
-    texCoord = min + texture * (max - min);
+    gl_Position = viewProjection * vec4(instanceOffset + position * instanceScale, 0, 1);
+    texCoord = instanceFrame.xy + texture * (instanceFrame.zw - instanceFrame.xy);
+    tint = instanceColor;
 }
@@ -1,6 +1,11 @@
 #version 330
 
-uniform mat4 matrix;
+// shared by every program, see frameuniforms.h
+layout(std140) uniform Frame {
+    mat4 viewProjection;
+};
+// xy is where the quad's origin goes in the world, zw scales it, negative to flip
+uniform vec4 transform;
 
 in vec2 position;
 in vec2 texture;
@@ -8,6 +13,6 @@ in vec2 texture;
 out vec2 texCoord;
 
 void main() {
-    gl_Position = matrix * vec4(position, 0, 1);
+    gl_Position = viewProjection * vec4(transform.xy + position * transform.zw, 0, 1);
     texCoord = texture;
 }
@@ -0,0 +1,23 @@
+#version 330
+
+uniform vec4 color;
+uniform sampler2D sampler;
+uniform usampler2DArray cells;
+uniform int layer;
+uniform int chunkSize;
+uniform ivec2 sheetTiles;
+uniform vec4 sheetRegion;
+
+in vec2 texCoord;
+
+out vec4 outColor;
+
+void main() {
+    vec2 cellPos = texCoord * chunkSize;
+    ivec2 cell = clamp(ivec2(floor(cellPos)), ivec2(0), ivec2(chunkSize - 1));
+    int index = int(texelFetch(cells, ivec3(cell, layer), 0).r);
+    // same tile order as makeChunkMesh, row by row across the sheet
+    vec2 tile = vec2(index % sheetTiles.x, (index / sheetTiles.x) % sheetTiles.y);
+    vec2 uv = (tile + fract(cellPos)) / vec2(sheetTiles);
+    outColor = texture2D(sampler, mix(sheetRegion.xy, sheetRegion.zw, uv)) * color;
+}
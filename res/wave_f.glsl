@@ -1,18 +1,15 @@
 #version 330
 
-uniform vec4 color;
-uniform float radius;
-uniform float thickness;
-
-in vec2 texCoord;
+// from the wave's center, in world units
+in vec2 offset;
+// radius, thickness
+in vec2 ring;
+in vec4 tint;
 
 out vec4 outColor;
 
 void main() {
-    vec2 diff = texCoord - vec2(0.5, 0.5);
-    float dist = sqrt(diff.x * diff.x + diff.y * diff.y);
-    if (abs(dist - radius) > thickness) {
-        discard;
-    }
-    outColor = vec4(vec3(1), (thickness - abs(dist - radius)) / thickness) * color;
+    // the geometry already covers just the ring, the corners it misses fade to nothing
+    float coverage = max(1.0 - abs(length(offset) - ring.x) / ring.y, 0.0);
+    outColor = vec4(tint.rgb, tint.a * coverage);
 }
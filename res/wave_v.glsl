@@ -0,0 +1,32 @@
+#version 330
+
+// shared by every program, see frameuniforms.h
+layout(std140) uniform Frame {
+    mat4 viewProjection;
+};
+
+// the sides of the polygon around each circle, must match WAVE_SEGMENTS
+const float SEGMENTS = 48.0;
+
+// xy is the direction from the center, z is -1 on the inner edge and +1 on the outer
+in vec3 position;
+
+// per instance, x of instanceScale is the radius and y the thickness
+in vec2 instanceOffset;
+in vec2 instanceScale;
+in vec4 instanceColor;
+
+out vec2 offset;
+out vec2 ring;
+out vec4 tint;
+
+void main() {
+    float radius = instanceScale.x;
+    float thickness = instanceScale.y;
+    // the outer edge is pushed out so the polygon's sides stay outside the circle
+    float distance = position.z < 0.0 ? max(radius - thickness, 0.0) : (radius + thickness) / cos(3.14159265 / SEGMENTS);
+    offset = position.xy * distance;
+    ring = instanceScale;
+    tint = instanceColor;
+    gl_Position = viewProjection * vec4(instanceOffset + offset, 0, 1);
+}
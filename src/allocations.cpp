@@ -0,0 +1,201 @@
+#include "allocations.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <iostream>
+#include <iomanip>
+
+static std::atomic<uint64_t> allocationCount = 0;
+static std::atomic<uint64_t> freeCount = 0;
+
+struct TagCounters {
+    std::atomic<int64_t> liveBytes = 0;
+    std::atomic<int64_t> peakBytes = 0;
+    std::atomic<uint64_t> allocations = 0;
+    std::atomic<uint64_t> frees = 0;
+    std::atomic<int64_t> budgetBytes = 0;
+    bool reportedOverBudget = false;
+};
+
+static TagCounters tagCounters[MEMORY_TAG_COUNT];
+thread_local MemoryTag currentTag = MEMORY_UNTAGGED;
+
+// every heap block starts with one of these so a free knows its size and tag
+struct alignas(16) AllocationHeader {
+    uint64_t size;
+    uint32_t tag;
+    // distance from the start of the malloc'd block to the pointer we handed out
+    uint32_t offset;
+};
+static_assert(sizeof(AllocationHeader) == 16);
+
+static void charge(MemoryTag tag, int64_t bytes) {
+    TagCounters& counters = tagCounters[tag];
+    int64_t live = counters.liveBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    int64_t peak = counters.peakBytes.load(std::memory_order_relaxed);
+    while (live > peak && !counters.peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+    counters.allocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+static void discharge(MemoryTag tag, int64_t bytes) {
+    TagCounters& counters = tagCounters[tag];
+    counters.liveBytes.fetch_sub(bytes, std::memory_order_relaxed);
+    counters.frees.fetch_add(1, std::memory_order_relaxed);
+}
+
+static void* allocateTagged(size_t size, size_t alignment, MemoryTag tag) {
+    if (alignment < sizeof(AllocationHeader)) {
+        alignment = sizeof(AllocationHeader);
+    }
+    size_t total = (size + alignment + alignment - 1) / alignment * alignment;
+    char* base = static_cast<char*>(alignment == sizeof(AllocationHeader) ? std::malloc(total) : std::aligned_alloc(alignment, total));
+    if (base == nullptr) {
+        return nullptr;
+    }
+    char* ptr = base + alignment;
+    AllocationHeader* header = reinterpret_cast<AllocationHeader*>(ptr) - 1;
+    header->size = size;
+    header->tag = tag;
+    header->offset = (uint32_t) alignment;
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    charge(tag, (int64_t) size);
+    return ptr;
+}
+
+static void freeTagged(void* ptr) {
+    if (ptr == nullptr) return;
+    AllocationHeader* header = static_cast<AllocationHeader*>(ptr) - 1;
+    freeCount.fetch_add(1, std::memory_order_relaxed);
+    discharge((MemoryTag) header->tag, (int64_t) header->size);
+    std::free(static_cast<char*>(ptr) - header->offset);
+}
+
+AllocationCounters allocationCounters() {
+    return {allocationCount.load(std::memory_order_relaxed), freeCount.load(std::memory_order_relaxed)};
+}
+
+const char* memoryTagName(MemoryTag tag) {
+    static const char* const names[MEMORY_TAG_COUNT] = {
+        "untagged", "grid", "physics", "render", "behavior", "assets", "gpu buffers", "gpu textures"
+    };
+    return names[tag];
+}
+
+MemoryScope::MemoryScope(MemoryTag tag) : previous(currentTag) {
+    currentTag = tag;
+}
+
+MemoryScope::~MemoryScope() {
+    currentTag = previous;
+}
+
+MemoryStats memoryStats(MemoryTag tag) {
+    const TagCounters& counters = tagCounters[tag];
+    return {
+        counters.liveBytes.load(std::memory_order_relaxed),
+        counters.peakBytes.load(std::memory_order_relaxed),
+        counters.allocations.load(std::memory_order_relaxed),
+        counters.frees.load(std::memory_order_relaxed),
+        counters.budgetBytes.load(std::memory_order_relaxed)
+    };
+}
+
+void trackAllocation(MemoryTag tag, size_t bytes) {
+    charge(tag, (int64_t) bytes);
+}
+
+void trackFree(MemoryTag tag, size_t bytes) {
+    discharge(tag, (int64_t) bytes);
+}
+
+void* trackedMalloc(MemoryTag tag, size_t bytes) {
+    return allocateTagged(bytes, sizeof(AllocationHeader), tag);
+}
+
+void trackedFree(void* ptr) {
+    freeTagged(ptr);
+}
+
+void setMemoryBudget(MemoryTag tag, size_t bytes) {
+    tagCounters[tag].budgetBytes.store((int64_t) bytes, std::memory_order_relaxed);
+    tagCounters[tag].reportedOverBudget = false;
+}
+
+MemoryReport memoryReport() {
+    MemoryReport report;
+    for (int i = 0; i < MEMORY_TAG_COUNT; ++i) {
+        report.tags[i] = memoryStats((MemoryTag) i);
+    }
+    return report;
+}
+
+void printMemoryReport(const MemoryReport& current, const MemoryReport& previous) {
+    std::cout << std::left << std::setw(14) << "memory" << std::right
+        << std::setw(12) << "live KB" << std::setw(12) << "peak KB" << std::setw(10) << "allocs" << std::setw(10) << "frees"
+        << std::setw(12) << "budget KB" << "\n";
+    for (int i = 0; i < MEMORY_TAG_COUNT; ++i) {
+        const MemoryStats& now = current.tags[i];
+        const MemoryStats& before = previous.tags[i];
+        std::cout << std::left << std::setw(14) << memoryTagName((MemoryTag) i) << std::right
+            << std::setw(12) << now.liveBytes / 1024 << std::setw(12) << now.peakBytes / 1024
+            << std::setw(10) << now.allocations - before.allocations << std::setw(10) << now.frees - before.frees
+            << std::setw(12);
+        if (now.budgetBytes > 0) {
+            std::cout << now.budgetBytes / 1024;
+        } else {
+            std::cout << "-";
+        }
+        std::cout << "\n";
+    }
+    std::cout << std::flush;
+}
+
+bool checkMemoryBudgets() {
+    bool withinBudget = true;
+    for (int i = 0; i < MEMORY_TAG_COUNT; ++i) {
+        TagCounters& counters = tagCounters[i];
+        int64_t budget = counters.budgetBytes.load(std::memory_order_relaxed);
+        int64_t live = counters.liveBytes.load(std::memory_order_relaxed);
+        bool over = budget > 0 && live > budget;
+        if (over && !counters.reportedOverBudget) {
+            std::cerr << "Memory budget exceeded for " << memoryTagName((MemoryTag) i) << ": "
+                << live / 1024 << " KB live, budget " << budget / 1024 << " KB" << std::endl;
+        }
+        counters.reportedOverBudget = over;
+        withinBudget = withinBudget && !over;
+    }
+    return withinBudget;
+}
+
+// replacements for the global operator new/delete, everything else forwards here
+void* operator new(std::size_t size) {
+    void* ptr = allocateTagged(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__, currentTag);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    void* ptr = allocateTagged(size, static_cast<size_t>(alignment), currentTag);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+    freeTagged(ptr);
+}
+
+void operator delete(void* ptr, std::size_t size) noexcept {
+    freeTagged(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t alignment) noexcept {
+    freeTagged(ptr);
+}
+
+void operator delete(void* ptr, std::size_t size, std::align_val_t alignment) noexcept {
+    freeTagged(ptr);
+}
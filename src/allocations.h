@@ -0,0 +1,71 @@
+#ifndef SRC_ALLOCATIONS_H_INCLUDED
+#define SRC_ALLOCATIONS_H_INCLUDED
+#include <cstdint>
+#include <cstddef>
+
+// running totals of calls to the global operator new/delete
+// take one before and after a frame and subtract to see what the frame did
+struct AllocationCounters {
+    uint64_t allocations;
+    uint64_t frees;
+};
+
+AllocationCounters allocationCounters();
+
+inline AllocationCounters operator-(AllocationCounters a, AllocationCounters b) {
+    return {a.allocations - b.allocations, a.frees - b.frees};
+}
+
+// which subsystem a byte of memory belongs to
+// heap allocations are charged to the tag of the innermost MemoryScope on their thread
+// the GPU tags are reported by src/graphics when buffers and textures are created
+enum MemoryTag : uint8_t {
+    MEMORY_UNTAGGED, MEMORY_GRID, MEMORY_PHYSICS, MEMORY_RENDER, MEMORY_BEHAVIOR, MEMORY_ASSETS,
+    MEMORY_GPU_BUFFERS, MEMORY_GPU_TEXTURES, MEMORY_TAG_COUNT
+};
+
+const char* memoryTagName(MemoryTag tag);
+
+class MemoryScope {
+public:
+    explicit MemoryScope(MemoryTag tag);
+    ~MemoryScope();
+    MemoryScope(const MemoryScope&) = delete;
+    MemoryScope& operator=(const MemoryScope&) = delete;
+private:
+    MemoryTag previous;
+};
+
+struct MemoryStats {
+    int64_t liveBytes;
+    int64_t peakBytes;
+    uint64_t allocations;
+    uint64_t frees;
+    // 0 means no budget
+    int64_t budgetBytes;
+};
+
+MemoryStats memoryStats(MemoryTag tag);
+
+// for memory that doesn't go through operator new, like GPU objects
+void trackAllocation(MemoryTag tag, size_t bytes);
+void trackFree(MemoryTag tag, size_t bytes);
+
+// heap allocation charged to an explicit tag, used for the Box2D hooks
+void* trackedMalloc(MemoryTag tag, size_t bytes);
+void trackedFree(void* ptr);
+
+void setMemoryBudget(MemoryTag tag, size_t bytes);
+
+// snapshot of every tag, subtract two of them to get what happened in between
+struct MemoryReport {
+    MemoryStats tags[MEMORY_TAG_COUNT];
+};
+
+MemoryReport memoryReport();
+// prints live and peak bytes plus allocations and frees since previous
+void printMemoryReport(const MemoryReport& current, const MemoryReport& previous);
+// prints a warning the first time a tag goes over its budget, returns false if any tag is over
+bool checkMemoryBudgets();
+
+#endif
@@ -0,0 +1,286 @@
+#include "bench.h"
+#include "kinds.h"
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include "graphics/graphics.h"
+#include "graphics/spritesheet.h"
+#include "graphics/spritebatch.h"
+#include "graphics/program.h"
+#include "graphics/stream.h"
+#include "graphics/glstate.h"
+#include "graphics/frameuniforms.h"
+#include "graphics/headless.h"
+#include "game.h"
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include <memory>
+#include <set>
+#include <string>
+
+namespace {
+
+const int BENCH_OBJECTS = 10000;
+const int BENCH_CONTACTS = 10000;
+const int BENCH_FRAMES = 300;
+const int BENCH_SPRITES = 10000;
+const int BENCH_RENDER_FRAMES = 60;
+// half with tile map chunks, half with mesh chunks
+const int BENCH_SCENE_FRAMES = 60;
+// the window Game opens is the same size
+const int BENCH_SCENE_WIDTH = 800;
+const int BENCH_SCENE_HEIGHT = 600;
+
+// stand-in for a draw call so the optimizer can't remove the dispatch
+volatile long benchSink = 0;
+
+double msSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// how GameObject looked before the type bits
+struct LegacyObject {
+    enum Type {
+        PLAYER, GROUND, ENEMY
+    };
+    std::set<Type> types;
+    std::string name;
+};
+
+void drawClap(size_t row) { benchSink = benchSink + 1; }
+void drawShoot(size_t row) { benchSink = benchSink + 2; }
+void drawPiece(size_t row) { benchSink = benchSink + 3; }
+void drawNothing(size_t row) {}
+
+// same shape as KIND_HANDLERS, without needing a GL context
+void (* const BENCH_DRAW[KIND_COUNT])(size_t) = {
+    drawNothing, drawNothing, drawClap, drawShoot, drawPiece
+};
+
+// a hidden window so rendering benchmarks don't need anything on screen,
+// or with headless no window at all
+class BenchContext {
+public:
+    BenchContext(int width, int height, bool headless) {
+        if (headless) {
+            offscreen = std::make_unique<HeadlessContext>(width, height);
+        } else {
+            if (!glfwInit())
+                throw std::runtime_error("Failed to initialize GLFW");
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+            glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+            window = glfwCreateWindow(width, height, "Benchmark", NULL, NULL);
+            if (!window) {
+                glfwTerminate();
+                throw std::runtime_error("Failed to create GLFW window");
+            }
+            glfwMakeContextCurrent(window);
+            gladLoadGLLoader((GLADloadproc) glfwGetProcAddress);
+            loadBufferStorage((GLADloadproc) glfwGetProcAddress);
+            glfwSwapInterval(0);
+            glViewport(0, 0, width, height);
+        }
+        glEnable(GL_BLEND);
+        glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ZERO);
+    }
+    // renderers have to be gone before this, it frees what they share and then the context
+    ~BenchContext() {
+        releaseFrameStream();
+        releasePrograms();
+        glState().invalidate();
+        offscreen.reset();
+        if (window) {
+            glfwDestroyWindow(window);
+            glfwTerminate();
+        }
+    }
+private:
+    GLFWwindow* window = nullptr;
+    std::unique_ptr<HeadlessContext> offscreen;
+};
+
+struct BenchSprite {
+    glm::vec2 position;
+    int texture;
+    int frame;
+};
+
+}
+
+bool runBenchmark(std::string_view name, bool headless) {
+    if (!std::getenv("DISPLAY") && !std::getenv("WAYLAND_DISPLAY")) {
+        headless = true;
+    }
+    if (name == "dispatch") {
+        benchDispatch();
+        return true;
+    }
+    if (name == "sprites") {
+        benchSprites(headless);
+        return true;
+    }
+    if (name == "scene") {
+        benchScene(headless);
+        return true;
+    }
+    return false;
+}
+
+void benchDispatch() {
+    std::default_random_engine random(1234);
+    std::uniform_int_distribution<int> kindDistribution(0, KIND_COUNT - 1);
+    std::uniform_int_distribution<int> objectDistribution(0, BENCH_OBJECTS - 1);
+
+    std::vector<std::unique_ptr<LegacyObject>> legacy;
+    std::vector<Kind> kinds;
+    std::vector<uint32_t> types;
+    for (int i = 0; i < BENCH_OBJECTS; ++i) {
+        Kind kind = (Kind) kindDistribution(random);
+        kinds.push_back(kind);
+        types.push_back(KIND_TYPES[kind]);
+
+        std::unique_ptr<LegacyObject> obj(new LegacyObject());
+        const char* names[KIND_COUNT] = {"Player", "Ground", "EnemyClap", "EnemyShoot", "EnemyShootPiece"};
+        obj->name = names[kind];
+        if (KIND_TYPES[kind] & TYPE_PLAYER) obj->types.insert(LegacyObject::PLAYER);
+        if (KIND_TYPES[kind] & TYPE_GROUND) obj->types.insert(LegacyObject::GROUND);
+        if (KIND_TYPES[kind] & TYPE_ENEMY) obj->types.insert(LegacyObject::ENEMY);
+        legacy.push_back(std::move(obj));
+    }
+    std::vector<std::pair<int, int>> contacts;
+    for (int i = 0; i < BENCH_CONTACTS; ++i) {
+        contacts.push_back({objectDistribution(random), objectDistribution(random)});
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    long legacyGroundContacts = 0;
+    for (int frame = 0; frame < BENCH_FRAMES; ++frame) {
+        for (const auto& contact : contacts) {
+            bool groundIsA = legacy[contact.first]->types.contains(LegacyObject::GROUND);
+            bool groundIsB = legacy[contact.second]->types.contains(LegacyObject::GROUND);
+            if (groundIsA != groundIsB) ++legacyGroundContacts;
+        }
+        for (const auto& obj : legacy) {
+            if (obj->name == "EnemyClap") drawClap(0);
+            if (obj->name == "EnemyShoot") drawShoot(0);
+            if (obj->name == "EnemyShootPiece") drawPiece(0);
+        }
+    }
+    double legacyMs = msSince(start);
+
+    start = std::chrono::steady_clock::now();
+    long groundContacts = 0;
+    for (int frame = 0; frame < BENCH_FRAMES; ++frame) {
+        for (const auto& contact : contacts) {
+            bool groundIsA = types[contact.first] & TYPE_GROUND;
+            bool groundIsB = types[contact.second] & TYPE_GROUND;
+            if (groundIsA != groundIsB) ++groundContacts;
+        }
+        for (size_t i = 0; i < kinds.size(); ++i) {
+            BENCH_DRAW[kinds[i]](i);
+        }
+    }
+    double kindMs = msSince(start);
+
+    if (legacyGroundContacts != groundContacts) {
+        std::cout << "dispatch: contact filters disagree!" << std::endl;
+    }
+    std::cout << "dispatch: " << BENCH_OBJECTS << " objects, " << BENCH_CONTACTS << " contacts, " << BENCH_FRAMES << " frames\n";
+    std::cout << "  std::set + name string: " << legacyMs * 1000.0 / BENCH_FRAMES << " us/frame\n";
+    std::cout << "  type bits + kind table: " << kindMs * 1000.0 / BENCH_FRAMES << " us/frame\n";
+    std::cout << "  speedup: " << legacyMs / kindMs << "x" << std::endl;
+}
+
+void benchSprites(bool headless) {
+    const int width = 800, height = 600;
+    BenchContext context(width, height, headless);
+    std::cout << "sprites: " << glGetString(GL_RENDERER) << std::endl;
+    {
+        GLuint textures[2] = {makeNearestTexture("res/enemy1.png"), makeNearestTexture("res/enemy2.png")};
+        SpritesheetRender spritesheetRender;
+        SpriteBatch spriteBatch;
+
+        std::default_random_engine random(1234);
+        std::uniform_real_distribution<float> x(0.0f, (float) width), y(0.0f, (float) height);
+        std::uniform_int_distribution<int> texture(0, 1), frame(0, 4);
+        std::vector<BenchSprite> sprites;
+        for (int i = 0; i < BENCH_SPRITES; ++i) {
+            sprites.push_back({{x(random), y(random)}, texture(random), frame(random)});
+        }
+        glm::mat4 proj = glm::ortho<float>(0, width, height, 0, 0, 1);
+        glm::vec2 scale = {16.0f, 16.0f};
+
+        double perSpriteSubmit = 0, perSpriteTotal = 0;
+        for (int f = 0; f < BENCH_RENDER_FRAMES; ++f) {
+            glClear(GL_COLOR_BUFFER_BIT);
+            auto start = std::chrono::steady_clock::now();
+            setFrameUniforms({proj});
+            for (const BenchSprite& sprite : sprites) {
+                glState().bindTexture(0, GL_TEXTURE_2D, textures[sprite.texture]);
+                spritesheetRender.render(sprite.position, scale, glm::vec4(1.0f), 0, textureGrid(4, 4, sprite.frame));
+            }
+            perSpriteSubmit += msSince(start);
+            glFinish();
+            frameStream().endFrame();
+            perSpriteTotal += msSince(start);
+        }
+
+        double batchSubmit = 0, batchTotal = 0;
+        for (int f = 0; f < BENCH_RENDER_FRAMES; ++f) {
+            glClear(GL_COLOR_BUFFER_BIT);
+            auto start = std::chrono::steady_clock::now();
+            setFrameUniforms({proj});
+            spriteBatch.begin();
+            for (const BenchSprite& sprite : sprites) {
+                spriteBatch.draw(0, textures[sprite.texture], sprite.position, scale, textureGrid(4, 4, sprite.frame), glm::vec4(1.0f));
+            }
+            spriteBatch.end();
+            batchSubmit += msSince(start);
+            glFinish();
+            frameStream().endFrame();
+            batchTotal += msSince(start);
+        }
+
+        std::vector<SpriteInstance> instances[2];
+        double instancedSubmit = 0, instancedTotal = 0;
+        for (int f = 0; f < BENCH_RENDER_FRAMES; ++f) {
+            glClear(GL_COLOR_BUFFER_BIT);
+            auto start = std::chrono::steady_clock::now();
+            setFrameUniforms({proj});
+            instances[0].clear();
+            instances[1].clear();
+            for (const BenchSprite& sprite : sprites) {
+                instances[sprite.texture].push_back({sprite.position, scale, textureGrid(4, 4, sprite.frame), glm::vec4(1.0f)});
+            }
+            for (int t = 0; t < 2; ++t) {
+                glState().bindTexture(0, GL_TEXTURE_2D, textures[t]);
+                spritesheetRender.render(0, instances[t]);
+            }
+            instancedSubmit += msSince(start);
+            glFinish();
+            frameStream().endFrame();
+            instancedTotal += msSince(start);
+        }
+
+        std::cout << "sprites: " << BENCH_SPRITES << " sprites, " << BENCH_RENDER_FRAMES << " frames\n";
+        std::cout << "  one draw per sprite: " << perSpriteSubmit / BENCH_RENDER_FRAMES << " ms submit, "
+            << perSpriteTotal / BENCH_RENDER_FRAMES << " ms with glFinish, " << BENCH_SPRITES << " draw calls\n";
+        std::cout << "  sprite batch:        " << batchSubmit / BENCH_RENDER_FRAMES << " ms submit, "
+            << batchTotal / BENCH_RENDER_FRAMES << " ms with glFinish, " << spriteBatch.stats().drawCalls << " draw calls\n";
+        std::cout << "  instanced:           " << instancedSubmit / BENCH_RENDER_FRAMES << " ms submit, "
+            << instancedTotal / BENCH_RENDER_FRAMES << " ms with glFinish, 2 draw calls" << std::endl;
+    }
+}
+
+void benchScene(bool headless) {
+    // the game's own frame loop, with the render thread, every render pass and the HUD
+    if (headless) {
+        HeadlessContext context(BENCH_SCENE_WIDTH, BENCH_SCENE_HEIGHT);
+        Game(&context).run(BENCH_SCENE_FRAMES);
+    } else {
+        Game().run(BENCH_SCENE_FRAMES);
+    }
+}
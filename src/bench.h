@@ -0,0 +1,24 @@
+#ifndef SRC_BENCH_H_INCLUDED
+#define SRC_BENCH_H_INCLUDED
+#include <string_view>
+
+// benchmarks are run with "myapp --bench <name> [--headless]" and print their results to stdout
+// headless renders through an EGL context into a framebuffer object instead of a hidden window,
+// it is also used when there is no DISPLAY or WAYLAND_DISPLAY to open a window on
+// returns false if there is no benchmark with that name
+bool runBenchmark(std::string_view name, bool headless = false);
+
+// compares std::set<Type> + name string dispatch against type bits + the KIND_HANDLERS table
+void benchDispatch();
+
+// CPU submit time for 10k sprites, one SpritesheetRender::render each vs one SpriteBatch
+// vs one instanced SpritesheetRender draw per texture
+// runs in a hidden window, use LIBGL_ALWAYS_SOFTWARE=1 to run on Mesa's software rasterizer
+void benchSprites(bool headless);
+
+// runs Game's frame loop on a seeded scene with a fixed time step, first with tile map chunks and then with meshes
+// prints main thread recording time, render thread execute time, draw calls and a checksum of the read back pixels
+// for every frame, the checksums only change when what is drawn changes
+void benchScene(bool headless);
+
+#endif
@@ -0,0 +1,23 @@
+#include "allocations.h"
+#include <box2d/box2d.h>
+#include <cstdio>
+#include <cstdarg>
+
+#ifdef B2_USER_SETTINGS
+// declared in include/b2_user_settings.h, Box2D calls these for all of its memory
+
+void* b2Alloc(int32 size) {
+    return trackedMalloc(MEMORY_PHYSICS, (size_t) size);
+}
+
+void b2Free(void* mem) {
+    trackedFree(mem);
+}
+
+void b2Log(const char* string, ...) {
+    va_list args;
+    va_start(args, string);
+    vprintf(string, args);
+    va_end(args);
+}
+#endif
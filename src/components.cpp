@@ -0,0 +1,100 @@
+#include "components.h"
+#include "util.h"
+
+Entity ComponentStore::create(GameObject* object, Kind kind) {
+    Entity entity;
+    if (!freeEntities.empty()) {
+        entity = freeEntities.back();
+        freeEntities.pop_back();
+    } else {
+        entity = (Entity) rows.size();
+        rows.push_back(0);
+    }
+    rows[entity] = (uint32_t) entities.size();
+    entities.push_back(entity);
+    objects.push_back(object);
+    kinds.push_back(kind);
+    transforms.push_back(Transform());
+    bodies.push_back(nullptr);
+    grounds.push_back(GroundState());
+    behaviors.push_back(BehaviorState());
+    sprites.push_back(Sprite());
+    return entity;
+}
+
+void ComponentStore::destroy(Entity entity) {
+    // swap the last row into the hole so the columns stay dense
+    size_t hole = row(entity);
+    size_t last = entities.size() - 1;
+    if (hole != last) {
+        entities[hole] = entities[last];
+        objects[hole] = objects[last];
+        kinds[hole] = kinds[last];
+        transforms[hole] = transforms[last];
+        bodies[hole] = bodies[last];
+        grounds[hole] = grounds[last];
+        behaviors[hole] = behaviors[last];
+        sprites[hole] = sprites[last];
+        rows[entities[hole]] = (uint32_t) hole;
+    }
+    entities.pop_back();
+    objects.pop_back();
+    kinds.pop_back();
+    transforms.pop_back();
+    bodies.pop_back();
+    grounds.pop_back();
+    behaviors.pop_back();
+    sprites.pop_back();
+    freeEntities.push_back(entity);
+}
+
+void ComponentStore::setBody(Entity entity, b2Body* body) {
+    size_t r = row(entity);
+    bodies[r] = body;
+    transforms[r].position = {body->GetPosition().x, body->GetPosition().y};
+    transforms[r].angle = body->GetAngle();
+}
+
+void resetGroundState(ComponentStore& components, float timeStep) {
+    size_t count = components.size();
+    b2Body* const* bodies = components.bodies.data();
+    GroundState* grounds = components.grounds.data();
+    for (size_t i = 0; i < count; ++i) {
+        if (bodies[i]->IsAwake()) {
+            grounds[i].onGround = false;
+            grounds[i].airTime += timeStep;
+        }
+    }
+}
+
+void syncTransforms(ComponentStore& components) {
+    size_t count = components.size();
+    b2Body* const* bodies = components.bodies.data();
+    Transform* transforms = components.transforms.data();
+    for (size_t i = 0; i < count; ++i) {
+        const b2Vec2& position = bodies[i]->GetPosition();
+        transforms[i].position = {position.x, position.y};
+        transforms[i].angle = bodies[i]->GetAngle();
+    }
+}
+
+// every enemy sheet shares the same layout: 2 sleeping frames, 2 waking frames, then the attack
+void updateSpriteFrames(ComponentStore& components) {
+    size_t count = components.size();
+    const BehaviorState* behaviors = components.behaviors.data();
+    Sprite* sprites = components.sprites.data();
+    for (size_t i = 0; i < count; ++i) {
+        const BehaviorState& state = behaviors[i];
+        switch (state.mode) {
+            case 0:
+                sprites[i].frame = constrain((int) (state.timer / (0.5f / 2)), 0, 1);
+                break;
+            case 1:
+                sprites[i].frame = constrain((int) (2 + state.timer / (0.2f / 2)), 2, 3);
+                break;
+            case 2:
+                sprites[i].frame = constrain((int) (5 - (state.timer - 0.8f) / (0.2f / 2)), 3, 4);
+                break;
+        }
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef SRC_COMPONENTS_H_INCLUDED
+#define SRC_COMPONENTS_H_INCLUDED
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <box2d/box2d.h>
+#include "kinds.h"
+
+// entities are stable ids, rows are positions in the dense columns
+// rows move around when entities are destroyed, ids never do
+using Entity = uint32_t;
+
+struct Transform {
+    glm::vec2 position = {0.0f, 0.0f};
+    float angle = 0.0f;
+};
+
+struct GroundState {
+    bool onGround = false;
+    float airTime = 0.0f;
+};
+
+// the state machine of a Behavior, kept here so animation doesn't need to look at the Behavior
+struct BehaviorState {
+    float timer = 0.0f;
+    int mode = 0;
+};
+
+enum SpriteSheet : uint8_t {
+    SPRITE_NONE, SPRITE_ENEMY_CLAP, SPRITE_ENEMY_SHOOT, SPRITE_SHEET_COUNT
+};
+
+struct Sprite {
+    SpriteSheet sheet = SPRITE_NONE;
+    bool faceRight = true;
+    int frame = 0;
+    glm::vec2 offset = {0.0f, 0.0f};
+    glm::vec2 scale = {1.0f, 1.0f};
+};
+
+// one table where every column is aligned by row, so systems can walk
+// only the columns they need with a plain index loop
+class ComponentStore {
+public:
+    Entity create(GameObject* object, Kind kind);
+    void destroy(Entity entity);
+    inline size_t row(Entity entity) const {
+        return rows[entity];
+    }
+    inline size_t size() const {
+        return entities.size();
+    }
+
+    inline Transform& transform(Entity entity) { return transforms[row(entity)]; }
+    inline GroundState& ground(Entity entity) { return grounds[row(entity)]; }
+    inline BehaviorState& behavior(Entity entity) { return behaviors[row(entity)]; }
+    inline Sprite& sprite(Entity entity) { return sprites[row(entity)]; }
+    void setBody(Entity entity, b2Body* body);
+
+    std::vector<Entity> entities;
+    std::vector<GameObject*> objects;
+    std::vector<Kind> kinds;
+    std::vector<Transform> transforms;
+    std::vector<b2Body*> bodies;
+    std::vector<GroundState> grounds;
+    std::vector<BehaviorState> behaviors;
+    std::vector<Sprite> sprites;
+private:
+    std::vector<uint32_t> rows;
+    std::vector<Entity> freeEntities;
+};
+
+// systems
+void resetGroundState(ComponentStore& components, float timeStep);
+void syncTransforms(ComponentStore& components);
+void updateSpriteFrames(ComponentStore& components);
+
+#endif
@@ -1,9 +1,7 @@
 #include "game.h"
 
 std::unique_ptr<GameObject> makeEnemyClap(World* world, glm::vec2 position) {
-    std::unique_ptr<GameObject> obj = std::unique_ptr<GameObject>(new GameObject(world));
-    obj->types = {GameObject::ENEMY, GameObject::GROUND};
-    obj->name = "EnemyClap";
+    std::unique_ptr<GameObject> obj = std::unique_ptr<GameObject>(new GameObject(world, KIND_ENEMY_CLAP));
     obj->behavior = std::unique_ptr<Behavior>(new EnemyClap(obj.get()));
     
     BoxBodyType* boxBody = new BoxBodyType();
@@ -35,8 +33,12 @@ std::unique_ptr<GameObject> makeEnemyClap(World* world, glm::vec2 position) {
     enemyFixture->SetFriction(1.0f);
     enemyFixture->SetRestitution(0.0f);
 
-    obj->rigidBody = enemyBody;
-    obj->fixture = enemyFixture;
+    obj->setBody(enemyBody, enemyFixture);
+
+    Sprite& sprite = obj->sprite();
+    sprite.sheet = SPRITE_ENEMY_CLAP;
+    sprite.offset = {0.0f, -0.5f};
+    sprite.scale = {2.0f, 2.0f};
 
     enemyBody->GetUserData().pointer = reinterpret_cast<uintptr_t>(obj.get());
 
@@ -46,6 +48,9 @@ std::unique_ptr<GameObject> makeEnemyClap(World* world, glm::vec2 position) {
 void EnemyClap::update(double timeStep, World* world) {
     GameObject* player = world->player.get();
     GameObject* enemy = gameObject;
+    BehaviorState& state = enemy->state();
+    float& timer = state.timer;
+    int& mode = state.mode;
     bool playerInRange = (player->rigidBody->GetPosition() - enemy->rigidBody->GetPosition()).Length() < 8;
     switch (mode) {
         case EnemyClap::ASLEEP:
@@ -54,7 +59,7 @@ void EnemyClap::update(double timeStep, World* world) {
                 if (timer > 0.5f) {
                     mode = EnemyClap::AWAKE;
                     timer -= 0.5f;
-                    enemy->faceRight = player->rigidBody->GetPosition().x > enemy->rigidBody->GetPosition().x;
+                    enemy->sprite().faceRight = player->rigidBody->GetPosition().x > enemy->rigidBody->GetPosition().x;
                 }
             } else {
                 timer -= timeStep;
@@ -71,7 +76,7 @@ void EnemyClap::update(double timeStep, World* world) {
                     mode = EnemyClap::ATTACKED;
                     timer -= 0.2f;
                     Wave wave;
-                    wave.center = glm::vec2(enemy->rigidBody->GetPosition().x + (!enemy->faceRight ? -0.76f : 0.76f), enemy->rigidBody->GetPosition().y - 0.65f);
+                    wave.center = glm::vec2(enemy->rigidBody->GetPosition().x + (!enemy->sprite().faceRight ? -0.76f : 0.76f), enemy->rigidBody->GetPosition().y - 0.65f);
                     wave.timer = 0.0f;
                     world->waves.push_back(wave);
                 }
@@ -82,7 +87,7 @@ void EnemyClap::update(double timeStep, World* world) {
             if (timer > 1.0f) {
                 mode = EnemyClap::AWAKE;
                 timer -= 1.0f;
-                enemy->faceRight = player->rigidBody->GetPosition().x > enemy->rigidBody->GetPosition().x;
+                enemy->sprite().faceRight = player->rigidBody->GetPosition().x > enemy->rigidBody->GetPosition().x;
             }
             break;
         default:
@@ -1,9 +1,7 @@
 #include "game.h"
 
 std::unique_ptr<GameObject> makeEnemyShoot(World* world, glm::vec2 position) {
-    std::unique_ptr<GameObject> obj = std::unique_ptr<GameObject>(new GameObject(world));
-    obj->types = {GameObject::ENEMY, GameObject::GROUND};
-    obj->name = "EnemyShoot";
+    std::unique_ptr<GameObject> obj = std::unique_ptr<GameObject>(new GameObject(world, KIND_ENEMY_SHOOT));
     EnemyShoot* behavior = new EnemyShoot(obj.get());
     obj->behavior = std::unique_ptr<Behavior>(behavior);
 
@@ -36,8 +34,12 @@ std::unique_ptr<GameObject> makeEnemyShoot(World* world, glm::vec2 position) {
     enemyFixture->SetFriction(1.0f);
     enemyFixture->SetRestitution(0.0f);
 
-    obj->rigidBody = enemyBody;
-    obj->fixture = enemyFixture;
+    obj->setBody(enemyBody, enemyFixture);
+
+    Sprite& sprite = obj->sprite();
+    sprite.sheet = SPRITE_ENEMY_SHOOT;
+    sprite.offset = {0.0f, -0.5f};
+    sprite.scale = {2.0f, 2.0f};
 
     enemyBody->GetUserData().pointer = reinterpret_cast<uintptr_t>(obj.get());
 
@@ -46,7 +48,7 @@ std::unique_ptr<GameObject> makeEnemyShoot(World* world, glm::vec2 position) {
         glm::vec2 pos;
         glm::vec2 size;
     };
-    std::vector<PieceSpecs> pieces = {
+    const PieceSpecs pieces[] = {
         {glm::vec2(+7.0f, +0.0f), glm::vec2(9, 7)},
         {glm::vec2(+0.0f, -7.5f), glm::vec2(7, 10)},
         {glm::vec2(-6.5f, +2.5f), glm::vec2(8, 8)},
@@ -55,14 +57,13 @@ std::unique_ptr<GameObject> makeEnemyShoot(World* world, glm::vec2 position) {
 
     float pixelScale = 1.0f / 16.0f;
     glm::vec2 centerOffsetPix(-0.5f, 7.5f);
+    behavior->pieces.reserve(std::size(pieces));
     for (PieceSpecs piece : pieces) {
-        std::unique_ptr<GameObject> pieceObject = std::unique_ptr<GameObject>(new GameObject(world));
+        std::unique_ptr<GameObject> pieceObject = std::unique_ptr<GameObject>(new GameObject(world, KIND_ENEMY_SHOOT_PIECE));
 
         BoxBodyType* boxBody = new BoxBodyType();
         boxBody->scale = glm::vec2(1.0f, 1.0f);
         pieceObject->bodyType = std::unique_ptr<BodyType>(boxBody);
-        pieceObject->types = {GameObject::GROUND};
-        pieceObject->name = "EnemyShootPiece";
 
         glm::vec2 center = position + (piece.pos + centerOffsetPix) * pixelScale;
         b2BodyDef bodyDef;
@@ -81,8 +82,7 @@ std::unique_ptr<GameObject> makeEnemyShoot(World* world, glm::vec2 position) {
         fixture->SetFriction(0.8f);
         fixture->SetDensity(1.0f);
         fixture->SetRestitution(0.2f);
-        pieceObject->rigidBody = body;
-        pieceObject->fixture = fixture;
+        pieceObject->setBody(body, fixture);
         body->GetUserData().pointer = reinterpret_cast<uintptr_t>(pieceObject.get());
 
         EnemyShoot::Piece actual = {
@@ -98,6 +98,9 @@ std::unique_ptr<GameObject> makeEnemyShoot(World* world, glm::vec2 position) {
 void EnemyShoot::update(double timeStep, World* world) {
     GameObject* player = world->player.get();
     GameObject* enemy = gameObject;
+    BehaviorState& state = enemy->state();
+    float& timer = state.timer;
+    int& mode = state.mode;
     bool playerInRange = (player->rigidBody->GetPosition() - enemy->rigidBody->GetPosition()).Length() < 8;
     switch (mode) {
         case EnemyShoot::ASLEEP:
@@ -123,7 +126,7 @@ void EnemyShoot::update(double timeStep, World* world) {
                     mode = EnemyShoot::POSTSHOOT;
                     timer -= 0.2f;
                     Wave wave;
-                    wave.center = glm::vec2(enemy->rigidBody->GetPosition().x + (!enemy->faceRight ? -0.76f : 0.76f), enemy->rigidBody->GetPosition().y - 0.65f);
+                    wave.center = glm::vec2(enemy->rigidBody->GetPosition().x + (!enemy->sprite().faceRight ? -0.76f : 0.76f), enemy->rigidBody->GetPosition().y - 0.65f);
                     wave.timer = 0.0f;
                     world->waves.push_back(wave);
                 }
@@ -35,6 +35,12 @@ void Camera::update() {
     invView = glm::inverse(view);
 }
 
+Bounds Camera::visibleBounds() const {
+    glm::vec2 a = toWorldCoordinate({0.0f, 0.0f});
+    glm::vec2 b = toWorldCoordinate({(float) windowWidth, (float) windowHeight});
+    return {glm::min(a, b), glm::max(a, b)};
+}
+
 glm::vec2 Camera::getCenter() const {
     return centerPos;
 }
@@ -62,9 +68,7 @@ glm::vec2 Camera::toScreenCoordinate(glm::vec2 screenCoordinate) const {
 }
 
 std::unique_ptr<GameObject> makePlayer(World* world, glm::vec2 position) {
-    std::unique_ptr<GameObject> obj = std::unique_ptr<GameObject>(new GameObject(world));
-    obj->types = {GameObject::PLAYER};
-    obj->name = "Player";
+    std::unique_ptr<GameObject> obj = std::unique_ptr<GameObject>(new GameObject(world, KIND_PLAYER));
     
     BoxBodyType* boxBody = new BoxBodyType();
     boxBody->scale = glm::vec2(0.7f, 1.5f);
@@ -95,19 +99,14 @@ std::unique_ptr<GameObject> makePlayer(World* world, glm::vec2 position) {
     playerFixture->SetFriction(0.1f);
     playerFixture->SetRestitution(0.0f);
 
-    obj->rigidBody = playerBody;
-    obj->fixture = playerFixture;
+    obj->setBody(playerBody, playerFixture);
 
     playerBody->GetUserData().pointer = reinterpret_cast<uintptr_t>(obj.get());
 
     return obj;
 }
 
-std::unique_ptr<GameObject> makeGroundType(World* world, Box bodyDef) {
-    std::unique_ptr<GameObject> obj = std::unique_ptr<GameObject>(new GameObject(world));
-    obj->types = {GameObject::GROUND};
-    obj->name = "Ground";
-    
+static void makeGroundBody(GameObject* obj, World* world, Box bodyDef) {
     BoxBodyType* boxBody = new BoxBodyType();
     boxBody->scale = bodyDef.scale;
     obj->bodyType = std::unique_ptr<BodyType>(boxBody);
@@ -120,42 +119,55 @@ std::unique_ptr<GameObject> makeGroundType(World* world, Box bodyDef) {
     b2Fixture* groundFixture = groundBody->CreateFixture(&b2GroundBox, 0.0f);
     groundFixture->SetFriction(0.8f);
 
-    obj->rigidBody = groundBody;
-    obj->fixture = groundFixture;
+    obj->setBody(groundBody, groundFixture);
 
-    groundBody->GetUserData().pointer = reinterpret_cast<uintptr_t>(obj.get());
+    groundBody->GetUserData().pointer = reinterpret_cast<uintptr_t>(obj);
+}
 
+std::unique_ptr<GameObject> makeGroundType(World* world, Box bodyDef) {
+    std::unique_ptr<GameObject> obj = std::unique_ptr<GameObject>(new GameObject(world, KIND_GROUND));
+    makeGroundBody(obj.get(), world, bodyDef);
     return obj;
 }
 
-std::vector<std::unique_ptr<GameObject>> makeGround(World* world, GridPos gridPos, Grid grid) {
+void makeGround(World* world, GridPos gridPos, const Grid& grid, ObjectArena<GameObject>& colliders) {
     glm::vec2 gridStart;
     gridStart.x = gridPos.x * GRID_SIZE;
     gridStart.y = gridPos.y * GRID_SIZE;
 
-    std::vector<std::unique_ptr<GameObject>> groundBodies;
+    colliders.clear();
     for (int y = 0; y < GRID_SIZE; ++y) {
         for (int x = 0; x < GRID_SIZE; ++x) {
             if (grid.blocks[y * GRID_SIZE + x] != air) {
-                groundBodies.push_back(std::move(makeGroundType(world, Box{gridStart + glm::vec2{x + 0.5f, y + 0.5f}, {1, 1}})));
+                GameObject* obj = colliders.emplace(world, KIND_GROUND);
+                makeGroundBody(obj, world, Box{gridStart + glm::vec2{x + 0.5f, y + 0.5f}, {1, 1}});
             }
         }
     }
-    return groundBodies;
 }
 
-GameObject::GameObject(World* world) : world(world) {
-    world->gameObjects.insert(this);
+GameObject::GameObject(World* world, Kind kind) : kind(kind), types(KIND_TYPES[kind]), world(world) {
+    entity = world->components.create(this, kind);
 }
 GameObject::~GameObject() {
     rigidBody->DestroyFixture(fixture);
     world->box2dWorld.DestroyBody(rigidBody);
-    world->gameObjects.erase(this);
+    world->objectIndex.remove(entity);
+    world->components.destroy(entity);
 }
-void GameObject::update(double timeStep, World* world) {
-    if (behavior.get() != nullptr) {
-        behavior->update(timeStep, world);
-    }
+void GameObject::setBody(b2Body* body, b2Fixture* fixture) {
+    this->rigidBody = body;
+    this->fixture = fixture;
+    world->components.setBody(entity, body);
+}
+GroundState& GameObject::ground() {
+    return world->components.ground(entity);
+}
+BehaviorState& GameObject::state() {
+    return world->components.behavior(entity);
+}
+Sprite& GameObject::sprite() {
+    return world->components.sprite(entity);
 }
 
 void Game::BeginContact(b2Contact* contact) {
@@ -172,20 +184,11 @@ void Game::PostSolve(b2Contact* contact, const b2ContactImpulse* impulse) {
     GameObject* objB = reinterpret_cast<GameObject*>(contact->GetFixtureB()->GetBody()->GetUserData().pointer);
 
     // find if ground collides with non ground
-    bool groundIsA = false;
-    if (objA->types.contains(GameObject::GROUND)) {
-        groundIsA = true;
-    }
-    if (objB->types.contains(GameObject::GROUND)) {
-        if (groundIsA) {
-            // ground colliding with ground? i don't care
-            return;
-        }
-    } else {
-        if (!groundIsA) {
-            // nonGround colliding with nonGround? i don't care
-            return;
-        }
+    // ground with ground or nonGround with nonGround? i don't care
+    bool groundIsA = objA->types & TYPE_GROUND;
+    bool groundIsB = objB->types & TYPE_GROUND;
+    if (groundIsA == groundIsB) {
+        return;
     }
     
     //b2Vec2 normal[2];
@@ -204,12 +207,8 @@ void Game::PostSolve(b2Contact* contact, const b2ContactImpulse* impulse) {
 
     if (contact->GetManifold()->localNormal.y > 0.5f) {
         // ground pushed object up
-        if (groundIsA) {
-            objB->onGround = true;
-            objB->airTime = 0;
-        } else {
-            objA->onGround = true;
-            objA->airTime = 0;
-        }
+        GroundState& ground = groundIsA ? objB->ground() : objA->ground();
+        ground.onGround = true;
+        ground.airTime = 0;
     }
 }
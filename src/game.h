@@ -12,7 +12,9 @@
 #include <vector>
 #include "graphics/graphics.h"
 #include "graphics/simple.h"
-#include "graphics/texture.h"
+#include "graphics/chunkmesh.h"
+#include "graphics/glstate.h"
+#include "graphics/stream.h"
 #include "util.h"
 #include <span>
 #define MY_PI 3.1415926535979323f
@@ -22,8 +24,15 @@
 #include <functional>
 #include "events.h"
 #include "physics.h"
+#include "components.h"
+#include "spatial.h"
+#include "kinds.h"
+#include "pool.h"
+#include "allocations.h"
+#include "pacing.h"
 #include <box2d/box2d.h>
 #include <set>
+#include <chrono>
 
 const float GRAV_ACCEL= 20.0f;
 const float MAX_FALL= 10.0f;
@@ -55,6 +64,8 @@ public:
     glm::vec2 getCenter() const;
     glm::vec2 toWorldCoordinate(glm::vec2 screenCoordinate) const;
     glm::vec2 toScreenCoordinate(glm::vec2 worldCoordinate) const;
+    // the part of the world that is on screen
+    Bounds visibleBounds() const;
 private:
     void update();
     int windowWidth, windowHeight;
@@ -63,31 +74,33 @@ private:
     glm::mat4 view, invView;
 };
 
-struct BodyType {};
-struct BoxBodyType : public BodyType {
+struct BodyType {
+    inline virtual ~BodyType() {}
+};
+struct BoxBodyType : public BodyType, public Pooled<BoxBodyType> {
     glm::vec2 scale;
 };
 
 class World;
 class Game;
 class Behavior;
-class GameObject {
+class GameObject : public Pooled<GameObject> {
 public:
-    enum Type {
-        PLAYER, GROUND, ENEMY
-    };
-    std::set<Type> types;
-    std::string name;
+    const Kind kind;
+    // ObjectType bits, always KIND_TYPES[kind]
+    const uint32_t types;
     std::unique_ptr<BodyType> bodyType;
     b2Body* rigidBody;
     b2Fixture* fixture;
-    GameObject(World* world);
-    virtual void update(double timeStep, World* world);
+    GameObject(World* world, Kind kind);
     virtual ~GameObject();
 
-    bool onGround = false;
-    float airTime = 0;
-    bool faceRight = true;
+    // the per-tick state lives in the World's ComponentStore, these look up this object's row
+    Entity entity;
+    void setBody(b2Body* body, b2Fixture* fixture);
+    GroundState& ground();
+    BehaviorState& state();
+    Sprite& sprite();
 
     // list of things this GameObject can do
     // to avoid duplication of code if multiple enemy types with different behaviors
@@ -107,24 +120,24 @@ public:
     GameObject* const gameObject;
 };
 
-class EnemyClap : public Behavior {
+class EnemyClap : public Behavior, public Pooled<EnemyClap> {
 public:
     inline EnemyClap(GameObject* gameObject) : Behavior(gameObject) {}
     virtual void update(double timeStep, World* world);
-    float timer = 0.0f;
+    // stored in BehaviorState::mode
     enum Mode {
         ASLEEP, AWAKE, ATTACKED
-    } mode = ASLEEP;
+    };
 };
 
-class EnemyShoot : public Behavior {
+class EnemyShoot : public Behavior, public Pooled<EnemyShoot> {
 public:
     inline EnemyShoot(GameObject* gameObject) : Behavior(gameObject) {}
     virtual void update(double timeStep, World* world);
-    float timer = 0.0f;
+    // stored in BehaviorState::mode
     enum Mode {
         ASLEEP, PRESHOOT, POSTSHOOT
-    } mode = ASLEEP;
+    };
     struct Piece {
         std::unique_ptr<GameObject> gameObject;
         glm::vec2 mainPos;
@@ -135,7 +148,7 @@ public:
 
 class Enemy : public GameObject {
 public:
-    inline Enemy(World* world) : GameObject(world) {}
+    inline Enemy(World* world, Kind kind) : GameObject(world, kind) {}
     float timer = 0.0f;
     enum Mode {
         ASLEEP, AWAKE, ATTACKED
@@ -155,7 +168,9 @@ public:
     b2World box2dWorld = b2World(b2Vec2(0.0f, GRAV_ACCEL));
     GridManager gridManager;
     Camera camera;
-    std::set<GameObject*> gameObjects;
+    ComponentStore components;
+    // sprite bounds, for finding what is on screen
+    SpatialIndex objectIndex = SpatialIndex(GRID_SIZE);
     std::vector<Wave> waves;
 
     std::unique_ptr<GameObject> player;
@@ -168,23 +183,81 @@ std::unique_ptr<GameObject> makePlayer(World* world, glm::vec2 position);
 std::unique_ptr<GameObject> makeEnemyClap(World* world, glm::vec2 position);
 std::unique_ptr<GameObject> makeEnemyShoot(World* world, glm::vec2 position);
 std::unique_ptr<GameObject> makeGroundType(World* world, Box bodyDef);
-std::vector<std::unique_ptr<GameObject>> makeGround(World* world, GridPos gridPos, Grid grid);
+// replaces the chunk's previous colliders, reusing the arena's memory
+void makeGround(World* world, GridPos gridPos, const Grid& grid, ObjectArena<GameObject>& colliders);
+
+// what the last frame drew and what it skipped for being off screen
+struct VisibilityStats {
+    int chunksVisible = 0;
+    int chunksCulled = 0;
+    int objectsVisible = 0;
+    int objectsCulled = 0;
+    int wavesVisible = 0;
+    int wavesCulled = 0;
+};
+
+// filled in by the render thread while it runs a frame, read by the main thread once that frame is done
+struct RenderFrameStats {
+    int commands = 0;
+    int drawCalls = 0;
+    int chunksVisible = 0;
+    int chunksCulled = 0;
+    double hudDrawMs = 0.0;
+    ChunkMeshStats chunkMeshes;
+    GLStateStats glState;
+    StreamStats stream;
+    bool persistentStream = false;
+    // when the frame was swapped
+    std::chrono::steady_clock::time_point presented;
+    // the render queue's CPU time, without the readback benchmark frames do for their checksum
+    double executeMs = 0.0;
+    double readbackMs = 0.0;
+    uint64_t checksum = 0;
+};
+
+class HeadlessContext;
 
 class Game : public b2ContactListener {
 public:
-    void run();
+    Game() = default;
+    // draws into the context's framebuffer instead of opening a window, there is no input
+    inline explicit Game(HeadlessContext* headless) : headless(headless) {}
+    // runs until the window is closed, or for benchFrames frames of a seeded scene with a fixed time step,
+    // printing each frame's CPU time, draw calls and a checksum of the pixels
+    void run(int benchFrames = 0);
     void move(float &x, float &y, float deltaf, float speed);
     void onResize(int width, int height);
     void onKey(int key, int scancode, int action, int mods);
     void onGLDebugMessage(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar *message);
 private:
-    GLFWwindow* window;
+    void openWindow();
+
+    GLFWwindow* window = nullptr;
+    HeadlessContext* headless = nullptr;
     int windowWidth = 0, windowHeight = 0;
     glm::mat4 proj;
     World world;
     bool foward;
     double physicsTime = 0;
     bool paused = false;
+    bool instancedSprites = false;
+    bool tileMapChunks = true;
+    bool chunkModeChanged = false;
+    AllocationCounters lastFrameAllocations = {0, 0};
+    size_t lastFrameScratch = 0;
+    MemoryReport lastFrameStartMemory = memoryReport();
+    MemoryReport lastFrameEndMemory = lastFrameStartMemory;
+    VisibilityStats lastFrameVisibility;
+    // renderStats belongs to the frame on the render thread, lastRenderStats is the last one it finished
+    RenderFrameStats renderStats;
+    RenderFrameStats lastRenderStats;
+    // the performance HUD, toggled with H
+    bool showHud = true;
+    long totalTicks = 0;
+    double lastHudMs = 0.0;
+    // vsync with V, the frame limit with L and how many frames can be queued with Q
+    PacingSettings pacing;
+    bool pacingChanged = false;
     //b2Body* groundBody;
     //b2Fixture* groundFixture;
     //b2Body* playerBody;
@@ -0,0 +1,344 @@
+#include "atlas.h"
+#include "glstate.h"
+#include "../profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+
+const int ATLAS_MIN_SIZE = 64;
+
+struct PackRect {
+    int width, height;
+    int x = 0, y = 0;
+    int page = -1;
+};
+
+// shelf packing: rects go left to right in rows as tall as their tallest rect
+// returns how many of the rects in order were placed, the rest are marked page -1
+static int packShelves(std::vector<PackRect>& rects, const std::vector<size_t>& order, int size, int page) {
+    int x = 0, y = 0, shelfHeight = 0, placed = 0;
+    for (size_t i : order) {
+        PackRect& rect = rects[i];
+        rect.page = -1;
+        if (x + rect.width > size) {
+            y += shelfHeight;
+            x = 0;
+            shelfHeight = 0;
+        }
+        if (rect.width > size || y + rect.height > size) {
+            continue;
+        }
+        rect.x = x;
+        rect.y = y;
+        rect.page = page;
+        x += rect.width;
+        shelfHeight = std::max(shelfHeight, rect.height);
+        ++placed;
+    }
+    return placed;
+}
+
+// fills pages starting at the smallest power of two that fits, returns the size of each page
+static std::vector<int> packPages(std::vector<PackRect>& rects, int maxSize) {
+    std::vector<size_t> remaining(rects.size());
+    for (size_t i = 0; i < rects.size(); ++i) {
+        remaining[i] = i;
+    }
+    // tallest first keeps the shelves full
+    std::stable_sort(remaining.begin(), remaining.end(), [&rects](size_t a, size_t b) {
+        return rects[a].height > rects[b].height;
+    });
+
+    std::vector<int> pageSizes;
+    while (!remaining.empty()) {
+        int page = (int) pageSizes.size();
+        int size = ATLAS_MIN_SIZE;
+        while (packShelves(rects, remaining, size, page) < (int) remaining.size() && size < maxSize) {
+            size *= 2;
+        }
+        std::vector<size_t> left;
+        for (size_t i : remaining) {
+            if (rects[i].page != page) {
+                left.push_back(i);
+            }
+        }
+        if (left.size() == remaining.size()) {
+            throw std::runtime_error("Image is too large for a " + std::to_string(maxSize) + " atlas");
+        }
+        pageSizes.push_back(size);
+        remaining = std::move(left);
+    }
+    return pageSizes;
+}
+
+std::vector<std::string> atlasFiles(const std::string& directory) {
+    std::vector<std::string> files;
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".png") {
+            files.push_back(entry.path().string());
+        }
+    }
+    // directory order isn't stable
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+AtlasImage decodeAtlasImage(const std::string& file) {
+    PROFILE_ZONE("decode image");
+    MemoryScope scope(MEMORY_ASSETS);
+    AtlasImage image;
+    image.name = std::filesystem::path(file).stem().string();
+    image.data = readImage(file, image.width, image.height);
+    return image;
+}
+
+AtlasLayout layoutAtlas(std::vector<AtlasImage> images, int padding, int maxSize) {
+    std::vector<PackRect> rects;
+    for (const AtlasImage& image : images) {
+        rects.push_back({image.width + padding * 2, image.height + padding * 2});
+    }
+    AtlasLayout layout;
+    layout.pageSizes = packPages(rects, maxSize);
+    layout.padding = padding;
+    for (size_t i = 0; i < images.size(); ++i) {
+        const PackRect& rect = rects[i];
+        int size = layout.pageSizes[rect.page];
+        int left = rect.x + padding, top = rect.y + padding;
+        layout.regions.push_back({rect.page, {
+            glm::vec2((float) left / size, (float) top / size),
+            glm::vec2((float) (left + images[i].width) / size, (float) (top + images[i].height) / size)
+        }, left, top, images[i].width, images[i].height});
+    }
+    layout.images = std::move(images);
+    return layout;
+}
+
+void AtlasLayout::compose(int page, GLubyte* target) const {
+    int size = pageSizes[page];
+    std::fill(target, target + (size_t) size * size * 4, 0);
+    for (size_t i = 0; i < images.size(); ++i) {
+        const AtlasImage& image = images[i];
+        const AtlasRegion& region = regions[i];
+        if (region.page != page) {
+            continue;
+        }
+        // clamping the source coordinates extrudes the border into the padding
+        for (int y = -padding; y < image.height + padding; ++y) {
+            int sourceY = constrain(y, 0, image.height - 1);
+            for (int x = -padding; x < image.width + padding; ++x) {
+                int sourceX = constrain(x, 0, image.width - 1);
+                const GLubyte* source = &image.data[((size_t) sourceY * image.width + sourceX) * 4];
+                GLubyte* pixel = &target[((size_t) (region.y + y) * size + region.x + x) * 4];
+                std::copy(source, source + 4, pixel);
+            }
+        }
+    }
+}
+
+// every source file's name, size and modification time, so touching an image rebakes the atlas
+static uint64_t atlasKey(const std::vector<std::string>& files, int padding, int maxSize) {
+    uint64_t hash = hashBytes(FNV_OFFSET, std::to_string(padding) + " " + std::to_string(maxSize));
+    for (const std::string& file : files) {
+        std::error_code error;
+        auto size = std::filesystem::file_size(file, error);
+        auto modified = std::filesystem::last_write_time(file, error).time_since_epoch().count();
+        hash = hashBytes(hash, file + " " + std::to_string(size) + " " + std::to_string(modified));
+    }
+    return hash;
+}
+
+AtlasLoader::AtlasLoader(WorkerPool& pool, const std::string& directory, int padding, int maxSize)
+        : padding(padding), maxSize(maxSize) {
+    std::vector<std::string> files = atlasFiles(directory);
+    cacheKey = atlasKey(files, padding, maxSize);
+    char name[40];
+    snprintf(name, sizeof(name), "atlas-%016llx.tex", (unsigned long long) cacheKey);
+    cachePath = (std::filesystem::path(TEXTURE_CACHE_DIRECTORY) / name).string();
+    loadStats.images = (int) files.size();
+    loadStats.threads = pool.threadCount();
+    if (cached.open(cachePath, cacheKey)) {
+        loadStats.cached = true;
+        return;
+    }
+    for (const std::string& file : files) {
+        decodes.push_back(pool.submit([file]() {
+            auto start = std::chrono::steady_clock::now();
+            AtlasImage image = decodeAtlasImage(file);
+            return Decoded{std::move(image), std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count()};
+        }));
+    }
+}
+
+TextureAtlas AtlasLoader::load() {
+    if (loadStats.cached) {
+        return TextureAtlas(cached);
+    }
+    auto start = std::chrono::steady_clock::now();
+    std::vector<AtlasImage> images;
+    for (std::future<Decoded>& decode : decodes) {
+        Decoded decoded = decode.get();
+        loadStats.decodeMs += decoded.milliseconds;
+        images.push_back(std::move(decoded.image));
+    }
+    decodes.clear();
+    auto decoded = std::chrono::steady_clock::now();
+    loadStats.waitMs = std::chrono::duration<double, std::milli>(decoded - start).count();
+    AtlasLayout layout = layoutAtlas(std::move(images), padding, maxSize);
+    // uploading from the freshly baked file means the pages are only composed once
+    bool baked = bakeAtlas(layout, cachePath, cacheKey) && cached.open(cachePath, cacheKey);
+    loadStats.bakeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - decoded).count();
+    return baked ? TextureAtlas(cached) : TextureAtlas(layout);
+}
+
+// region metadata: name length, name, then page, x, y, width and height, for each region
+static void writeValue(std::vector<GLubyte>& out, int32_t value) {
+    const GLubyte* bytes = (const GLubyte*) &value;
+    out.insert(out.end(), bytes, bytes + sizeof(value));
+}
+
+static int32_t readValue(std::span<const GLubyte>& in) {
+    if (in.size() < sizeof(int32_t)) {
+        throw std::runtime_error("Truncated atlas metadata");
+    }
+    int32_t value;
+    std::copy(in.begin(), in.begin() + sizeof(value), (GLubyte*) &value);
+    in = in.subspan(sizeof(value));
+    return value;
+}
+
+bool bakeAtlas(const AtlasLayout& layout, const std::string& path, uint64_t key) {
+    MemoryScope scope(MEMORY_ASSETS);
+    std::vector<GLubyte> metadata;
+    for (size_t i = 0; i < layout.images.size(); ++i) {
+        const std::string& name = layout.images[i].name;
+        const AtlasRegion& region = layout.regions[i];
+        writeValue(metadata, (int32_t) name.size());
+        metadata.insert(metadata.end(), name.begin(), name.end());
+        for (int value : {region.page, region.x, region.y, region.width, region.height}) {
+            writeValue(metadata, value);
+        }
+    }
+    std::vector<std::vector<GLubyte>> pages;
+    std::vector<TextureBakeImage> images;
+    for (size_t page = 0; page < layout.pageSizes.size(); ++page) {
+        int size = layout.pageSizes[page];
+        pages.emplace_back((size_t) size * size * 4);
+        layout.compose((int) page, pages.back().data());
+        images.push_back({size, size, pages.back()});
+    }
+    // atlas pages are sampled with GL_NEAREST, so no mips are stored
+    return bakeTextureFile(path, key, images, false, metadata);
+}
+
+static AtlasLayout decodeDirectory(const std::string& directory, int padding, int maxSize) {
+    std::vector<AtlasImage> images;
+    for (const std::string& file : atlasFiles(directory)) {
+        images.push_back(decodeAtlasImage(file));
+    }
+    return layoutAtlas(std::move(images), padding, maxSize);
+}
+
+TextureAtlas::TextureAtlas(const std::string& directory, int padding, int maxSize)
+        : TextureAtlas(decodeDirectory(directory, padding, maxSize)) {}
+
+TextureAtlas::TextureAtlas(const AtlasLayout& layout) {
+    MemoryScope scope(MEMORY_ASSETS);
+    for (size_t i = 0; i < layout.images.size(); ++i) {
+        regions.insert({layout.images[i].name, layout.regions[i]});
+    }
+
+    // pages are composed straight into mapped buffer memory, so the driver can copy
+    // them into the textures without blocking on a client-side array
+    std::vector<size_t> offsets;
+    size_t total = 0;
+    for (int size : layout.pageSizes) {
+        offsets.push_back(total);
+        total += (size_t) size * size * 4;
+    }
+    GLuint pbo;
+    glGenBuffers(1, &pbo);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, total, nullptr, GL_STREAM_DRAW);
+    GLubyte* mapped = (GLubyte*) glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, total, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    std::vector<GLubyte> fallback;
+    if (mapped == nullptr) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        fallback.resize(total);
+    }
+    GLubyte* pixels = mapped ? mapped : fallback.data();
+    for (size_t page = 0; page < layout.pageSizes.size(); ++page) {
+        layout.compose((int) page, pixels + offsets[page]);
+    }
+    if (mapped) {
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    }
+
+    shared = std::shared_ptr<Shared>(new Shared());
+    for (size_t page = 0; page < layout.pageSizes.size(); ++page) {
+        int size = layout.pageSizes[page];
+        // with the pixel buffer bound the last argument is an offset into it
+        const void* source = mapped ? (const void*) offsets[page] : (const void*) (fallback.data() + offsets[page]);
+        GLuint tex;
+        glGenTextures(1, &tex);
+        glState().bindTexture(0, GL_TEXTURE_2D, tex);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, source);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        trackTexture(tex, (size_t) size * size * 4);
+        shared->textures.push_back(tex);
+    }
+    // the buffer is only freed once the uploads that read it are done
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glDeleteBuffers(1, &pbo);
+}
+
+TextureAtlas::TextureAtlas(const TextureFile& file) {
+    MemoryScope scope(MEMORY_ASSETS);
+    shared = std::shared_ptr<Shared>(new Shared());
+    for (int page = 0; page < file.imageCount(); ++page) {
+        shared->textures.push_back(file.upload(page, GL_NEAREST, GL_NEAREST));
+    }
+    std::span<const GLubyte> metadata = file.metadata();
+    while (!metadata.empty()) {
+        int32_t length = readValue(metadata);
+        if (length < 0 || (size_t) length > metadata.size()) {
+            throw std::runtime_error("Truncated atlas metadata");
+        }
+        std::string name(metadata.begin(), metadata.begin() + length);
+        metadata = metadata.subspan(length);
+        AtlasRegion region;
+        region.page = readValue(metadata);
+        region.x = readValue(metadata);
+        region.y = readValue(metadata);
+        region.width = readValue(metadata);
+        region.height = readValue(metadata);
+        if (region.page < 0 || region.page >= file.imageCount()) {
+            throw std::runtime_error("Atlas region " + name + " is on a page the file doesn't have");
+        }
+        float size = (float) file.level(region.page, 0).width;
+        region.spec = {
+            glm::vec2(region.x / size, region.y / size),
+            glm::vec2((region.x + region.width) / size, (region.y + region.height) / size)
+        };
+        regions.insert({name, region});
+    }
+}
+
+const AtlasRegion& TextureAtlas::region(std::string_view name) const {
+    auto p = regions.find(name);
+    if (p == regions.end()) {
+        throw std::runtime_error("No image named " + std::string(name) + " in the atlas");
+    }
+    return p->second;
+}
+
+TextureAtlas::Shared::~Shared() {
+    for (GLuint tex : textures) {
+        untrackTexture(tex);
+        glState().forgetTexture(tex);
+    }
+    glDeleteTextures((GLsizei) textures.size(), textures.data());
+}
@@ -0,0 +1,116 @@
+#ifndef _GRAPHICS_ATLAS_H
+#define _GRAPHICS_ATLAS_H
+#include "graphics.h"
+#include "spritesheet.h"
+#include "../workers.h"
+#include "texturefile.h"
+#include <future>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// where one image ended up, spec is in texture coordinates of its page
+struct AtlasRegion {
+    int page;
+    SpritesheetSpec spec;
+    int x, y, width, height;
+};
+
+struct AtlasImage {
+    std::string name;
+    std::vector<GLubyte> data;
+    int width = 0, height = 0;
+};
+
+// where each image goes, worked out without touching GL so it can run on any thread
+struct AtlasLayout {
+    std::vector<AtlasImage> images;
+    // one per image, in the same order
+    std::vector<AtlasRegion> regions;
+    std::vector<int> pageSizes;
+    int padding = 0;
+    // writes the page's size * size RGBA pixels into target
+    void compose(int page, GLubyte* target) const;
+};
+
+// writes the layout's pages as a texture file with the regions as metadata
+bool bakeAtlas(const AtlasLayout& layout, const std::string& path, uint64_t key);
+
+// the .png files in a directory, sorted so the layout is the same between runs
+std::vector<std::string> atlasFiles(const std::string& directory);
+AtlasImage decodeAtlasImage(const std::string& file);
+AtlasLayout layoutAtlas(std::vector<AtlasImage> images, int padding = 2, int maxSize = 2048);
+
+struct AtlasLoadStats {
+    int images = 0;
+    int threads = 0;
+    // the pages came out of the texture cache, nothing was decoded
+    bool cached = false;
+    // decode time summed over the workers, how long load() blocked for them, and writing the cache
+    double decodeMs = 0.0;
+    double waitMs = 0.0;
+    double bakeMs = 0.0;
+};
+
+class TextureAtlas;
+
+// loads an atlas from the texture cache when it was baked from the same images,
+// otherwise starts decoding every .png in the directory on the pool as soon as it is constructed,
+// so decoding overlaps window creation and shader compiles
+class AtlasLoader {
+public:
+    AtlasLoader(WorkerPool& pool, const std::string& directory, int padding = 2, int maxSize = 2048);
+    // uploads the atlas, call on the GL thread
+    // after a decode the pages are baked into the cache for the next run
+    TextureAtlas load();
+    inline const AtlasLoadStats& stats() const {
+        return loadStats;
+    }
+private:
+    struct Decoded {
+        AtlasImage image;
+        double milliseconds;
+    };
+    std::vector<std::future<Decoded>> decodes;
+    int padding, maxSize;
+    std::string cachePath;
+    uint64_t cacheKey;
+    TextureFile cached;
+    AtlasLoadStats loadStats;
+};
+
+// packs every .png in a directory into as few textures as possible at startup,
+// so sprites from different files can be drawn without rebinding
+// images are named by their file name without the extension, e.g. "enemy1"
+class TextureAtlas {
+public:
+    // padding is filled with copies of each image's border so neighbours never bleed in
+    // decodes on the calling thread, AtlasLoader does the same off the main thread
+    explicit TextureAtlas(const std::string& directory, int padding = 2, int maxSize = 2048);
+    // only the upload happens here, through a pixel buffer the pages are composed straight into
+    explicit TextureAtlas(const AtlasLayout& layout);
+    // pages and regions from a file written by bakeAtlas(), uploaded straight from the mapping
+    explicit TextureAtlas(const TextureFile& file);
+    // throws if there is no image with that name
+    const AtlasRegion& region(std::string_view name) const;
+    inline GLuint texture(int page = 0) const {
+        return shared->textures[page];
+    }
+    inline GLuint texture(const AtlasRegion& region) const {
+        return shared->textures[region.page];
+    }
+    inline int pageCount() const {
+        return (int) shared->textures.size();
+    }
+private:
+    // Shared is used so that atlases can be copied and still work just fine
+    struct Shared {
+        std::vector<GLuint> textures;
+        ~Shared();
+    };
+    std::shared_ptr<Shared> shared;
+    std::map<std::string, AtlasRegion, std::less<>> regions;
+};
+
+#endif
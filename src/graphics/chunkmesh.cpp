@@ -0,0 +1,209 @@
+#include "chunkmesh.h"
+#include "program.h"
+#include "glstate.h"
+#include "stream.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+const size_t CHUNK_MESH_INITIAL_VERTICES = 64 * 1024;
+
+size_t RangeAllocator::allocate(size_t size) {
+    for (auto p = freeBlocks.begin(); p != freeBlocks.end(); ++p) {
+        if (p->second >= size) {
+            size_t offset = p->first;
+            size_t rest = p->second - size;
+            freeBlocks.erase(p);
+            if (rest > 0) {
+                freeBlocks.insert({offset + size, rest});
+            }
+            return offset;
+        }
+    }
+    return SIZE_MAX;
+}
+
+void RangeAllocator::release(size_t offset, size_t size) {
+    if (size == 0) {
+        return;
+    }
+    auto next = freeBlocks.lower_bound(offset);
+    if (next != freeBlocks.end() && offset + size == next->first) {
+        size += next->second;
+        next = freeBlocks.erase(next);
+    }
+    if (next != freeBlocks.begin()) {
+        auto previous = std::prev(next);
+        if (previous->first + previous->second == offset) {
+            previous->second += size;
+            return;
+        }
+    }
+    freeBlocks.insert({offset, size});
+}
+
+void RangeAllocator::extend(size_t offset, size_t size) {
+    release(offset, size);
+}
+
+ChunkMeshBuffer::ChunkMeshBuffer(int maxQuadsPerChunk, int sheetTilesX, int sheetTilesY)
+        : maxQuadsPerChunk(maxQuadsPerChunk), sheetTilesX(sheetTilesX), sheetTilesY(sheetTilesY) {
+    const ShaderProgram& program = loadProgram("res/chunk_v.glsl", "res/texture_f.glsl");
+    uniformColor = program.uniform("color");
+    uniformSampler = program.uniform("sampler");
+    uniformSheetTiles = program.uniform("sheetTiles");
+    uniformSheetRegion = program.uniform("sheetRegion");
+
+    GLuint vao;
+    glGenVertexArrays(1, &vao);
+    glState().bindVertexArray(vao);
+
+    // one set of quad indices that every chunk's mesh shares through base vertex
+    std::vector<GLushort> indices(maxQuadsPerChunk * 6);
+    for (int i = 0; i < maxQuadsPerChunk; ++i) {
+        GLushort first = (GLushort) (i * 4);
+        GLushort quad[] = {first, (GLushort) (first + 1), (GLushort) (first + 2), (GLushort) (first + 2), (GLushort) (first + 3), first};
+        std::copy(quad, quad + 6, indices.begin() + i * 6);
+    }
+    GLuint ibo;
+    glGenBuffers(1, &ibo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLushort), indices.data(), GL_STATIC_DRAW);
+    trackBuffer(ibo, indices.size() * sizeof(GLushort));
+
+    // the mesh buffer itself is made by grow(), the per draw data goes through frameStream()
+    glEnableVertexAttribArray(ATTRIB_INSTANCE_OFFSET);
+    glVertexAttribDivisor(ATTRIB_INSTANCE_OFFSET, 1);
+
+    shared = std::shared_ptr<Shared>(new Shared());
+    shared->program = program.id;
+    shared->vbo = 0;
+    shared->ibo = ibo;
+    shared->vao = vao;
+    grow(CHUNK_MESH_INITIAL_VERTICES);
+}
+
+// doubles the mesh buffer and copies the live meshes across, their offsets stay the same
+void ChunkMeshBuffer::grow(size_t minimumVertices) {
+    size_t capacity = std::max(shared->capacity * 2, minimumVertices);
+    GLuint vbo;
+    glGenBuffers(1, &vbo);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, vbo);
+    glBufferData(GL_COPY_WRITE_BUFFER, capacity * sizeof(ChunkVertex), nullptr, GL_STATIC_DRAW);
+    trackBuffer(vbo, capacity * sizeof(ChunkVertex));
+    if (shared->capacity > 0) {
+        glBindBuffer(GL_COPY_READ_BUFFER, shared->vbo);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, shared->capacity * sizeof(ChunkVertex));
+    }
+    if (shared->vbo != 0) {
+        untrackBuffer(shared->vbo);
+        glDeleteBuffers(1, &shared->vbo);
+    }
+    allocator.extend(shared->capacity, capacity - shared->capacity);
+    shared->vbo = vbo;
+    shared->capacity = capacity;
+
+    // unnormalized bytes become floats holding the cell and tile numbers
+    glState().bindVertexArray(shared->vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glEnableVertexAttribArray(ATTRIB_POSITION);
+    glVertexAttribPointer(ATTRIB_POSITION, 2, GL_UNSIGNED_BYTE, false, sizeof(ChunkVertex), (void*) offsetof(ChunkVertex, x));
+    glEnableVertexAttribArray(ATTRIB_TEXTURE);
+    glVertexAttribPointer(ATTRIB_TEXTURE, 2, GL_UNSIGNED_BYTE, false, sizeof(ChunkVertex), (void*) offsetof(ChunkVertex, u));
+}
+
+int ChunkMeshBuffer::upload(std::span<const ChunkVertex> vertices, int handle) {
+    size_t count = vertices.size();
+    if (handle < 0) {
+        if (freeSlots.empty()) {
+            freeSlots.push_back((int) slots.size());
+            slots.push_back(Slot());
+        }
+        handle = freeSlots.back();
+        freeSlots.pop_back();
+        slots[handle].used = true;
+        ++liveChunks;
+    }
+    Slot& slot = slots[handle];
+    if (slot.count != count) {
+        allocator.release(slot.first, slot.count);
+        usedVertices -= slot.count;
+        size_t first = allocator.allocate(count);
+        if (first == SIZE_MAX) {
+            grow(shared->capacity + count);
+            first = allocator.allocate(count);
+        }
+        slot.first = first;
+        slot.count = count;
+        usedVertices += count;
+    }
+    if (count == 0) {
+        return handle;
+    }
+    // staged through the stream and copied on the GPU, so a mesh that is still being drawn doesn't stall us
+    StreamAllocation staged = frameStream().write(vertices);
+    glBindBuffer(GL_COPY_READ_BUFFER, staged.buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, shared->vbo);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, staged.offset, slot.first * sizeof(ChunkVertex), vertices.size_bytes());
+    return handle;
+}
+
+void ChunkMeshBuffer::release(int handle) {
+    Slot& slot = slots[handle];
+    allocator.release(slot.first, slot.count);
+    usedVertices -= slot.count;
+    slot = Slot();
+    freeSlots.push_back(handle);
+    --liveChunks;
+}
+
+void ChunkMeshBuffer::begin() {
+    commands.clear();
+    positions.clear();
+}
+
+void ChunkMeshBuffer::add(int handle, glm::vec2 position) {
+    const Slot& slot = slots[handle];
+    if (slot.count == 0) {
+        return;
+    }
+    // base vertex finds the mesh, base instance picks this draw's position out of the offset buffer
+    commands.push_back({(GLuint) (slot.count / 4 * 6), 1, 0, (GLint) slot.first, (GLuint) positions.size()});
+    positions.push_back(position);
+}
+
+void ChunkMeshBuffer::end(glm::vec4 color, GLint sampler, SpritesheetSpec sheet) {
+    lastStats = ChunkMeshStats();
+    lastStats.chunks = (int) commands.size();
+    lastStats.usedVertices = usedVertices;
+    lastStats.capacityVertices = shared->capacity;
+    lastStats.vertexBytes = usedVertices * sizeof(ChunkVertex);
+    lastStats.unpackedBytes = (size_t) liveChunks * maxQuadsPerChunk * 6 * 4 * sizeof(GLfloat);
+    if (commands.empty()) {
+        return;
+    }
+    StreamAllocation offsets = frameStream().write(std::span<const glm::vec2>(positions));
+    StreamAllocation indirect = frameStream().write(std::span<const DrawCommand>(commands));
+    glState().bindVertexArray(shared->vao);
+    glBindBuffer(GL_ARRAY_BUFFER, offsets.buffer);
+    glVertexAttribPointer(ATTRIB_INSTANCE_OFFSET, 2, GL_FLOAT, false, sizeof(glm::vec2), (void*) offsets.offset);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect.buffer);
+
+    glState().useProgram(shared->program);
+    glUniform4f(uniformColor, color.x, color.y, color.z, color.w);
+    glUniform1i(uniformSampler, sampler);
+    glUniform2f(uniformSheetTiles, (float) sheetTilesX, (float) sheetTilesY);
+    glUniform4f(uniformSheetRegion, sheet.min.x, sheet.min.y, sheet.max.x, sheet.max.y);
+    glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_SHORT, (void*) indirect.offset, (GLsizei) commands.size(), 0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    lastStats.drawCalls = 1;
+}
+
+ChunkMeshBuffer::Shared::~Shared() {
+    untrackBuffer(vbo);
+    untrackBuffer(ibo);
+    glDeleteBuffers(1, &vbo);
+    glDeleteBuffers(1, &ibo);
+    glState().forgetVertexArray(vao);
+    glDeleteVertexArrays(1, &vao);
+}
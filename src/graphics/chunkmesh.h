@@ -0,0 +1,97 @@
+#ifndef _GRAPHICS_CHUNKMESH_H
+#define _GRAPHICS_CHUNKMESH_H
+#include "graphics.h"
+#include "spritesheet.h"
+#include "../grid.h"
+#include <map>
+#include <memory>
+#include <span>
+#include <vector>
+
+// first fit over a range of units, freed blocks are merged with their neighbours
+class RangeAllocator {
+public:
+    // returns SIZE_MAX when there is no free block large enough
+    size_t allocate(size_t size);
+    void release(size_t offset, size_t size);
+    // adds [offset, offset + size) to the free space, used when the backing storage grows
+    void extend(size_t offset, size_t size);
+private:
+    // offset -> size
+    std::map<size_t, size_t> freeBlocks;
+};
+
+struct ChunkMeshStats {
+    int chunks = 0;
+    int drawCalls = 0;
+    size_t usedVertices = 0;
+    size_t capacityVertices = 0;
+    // the meshes as stored, and what every cell of the live chunks would take as 6 unindexed vertices of 4 floats
+    size_t vertexBytes = 0;
+    size_t unpackedBytes = 0;
+};
+
+// every chunk mesh lives in one shared vertex buffer, and all chunks added between
+// begin() and end() are drawn with a single glMultiDrawElementsIndirect
+// meshes are makeChunkMesh quads sharing one static index buffer, the chunk's world position
+// goes through a per draw attribute picked by base instance
+class ChunkMeshBuffer {
+public:
+    ChunkMeshBuffer(int maxQuadsPerChunk, int sheetTilesX, int sheetTilesY);
+    // returns a handle, updating a mesh in place when the vertex count is unchanged
+    int upload(std::span<const ChunkVertex> vertices, int handle = -1);
+    void release(int handle);
+    void begin();
+    void add(int handle, glm::vec2 position);
+    // sheet is where the tile sheet is in the bound texture
+    void end(glm::vec4 color, GLint sampler, SpritesheetSpec sheet);
+    // for render queue sort keys
+    inline GLuint program() const {
+        return (GLuint) shared->program;
+    }
+    inline const ChunkMeshStats& stats() const {
+        return lastStats;
+    }
+private:
+    struct Slot {
+        size_t first = 0;
+        size_t count = 0;
+        bool used = false;
+    };
+    struct DrawCommand {
+        GLuint count;
+        GLuint instanceCount;
+        GLuint firstIndex;
+        GLint baseVertex;
+        GLuint baseInstance;
+    };
+    void grow(size_t minimumVertices);
+
+    // Shared is used so that Renders can be copied and still work just fine
+    struct Shared {
+        GLint program;
+        GLuint vbo;
+        GLuint ibo;
+        GLuint vao;
+        size_t capacity = 0;
+        ~Shared();
+    };
+    std::shared_ptr<Shared> shared;
+    GLint uniformColor;
+    GLint uniformSampler;
+    GLint uniformSheetTiles;
+    GLint uniformSheetRegion;
+    int maxQuadsPerChunk;
+    int sheetTilesX, sheetTilesY;
+
+    RangeAllocator allocator;
+    std::vector<Slot> slots;
+    std::vector<int> freeSlots;
+    size_t usedVertices = 0;
+    int liveChunks = 0;
+    std::vector<DrawCommand> commands;
+    std::vector<glm::vec2> positions;
+    ChunkMeshStats lastStats;
+};
+
+#endif
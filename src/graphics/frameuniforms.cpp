@@ -0,0 +1,13 @@
+#include "frameuniforms.h"
+#include "stream.h"
+#include <algorithm>
+
+void setFrameUniforms(const FrameUniforms& uniforms) {
+    static GLint alignment = 0;
+    if (alignment == 0) {
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        alignment = std::max(alignment, 16);
+    }
+    StreamAllocation block = frameStream().write(&uniforms, sizeof(uniforms), alignment);
+    glBindBufferRange(GL_UNIFORM_BUFFER, FRAME_UNIFORM_BINDING, block.buffer, block.offset, sizeof(uniforms));
+}
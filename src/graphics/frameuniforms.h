@@ -0,0 +1,17 @@
+#ifndef _GRAPHICS_FRAMEUNIFORMS_H
+#define _GRAPHICS_FRAMEUNIFORMS_H
+#include "graphics.h"
+
+// the uniform block binding every program's Frame block is attached to by loadProgram()
+const GLuint FRAME_UNIFORM_BINDING = 0;
+
+// laid out as the std140 Frame block in the shaders, only add members in std140 order
+struct FrameUniforms {
+    glm::mat4 viewProjection;
+};
+
+// writes the block into frameStream() and binds it, draws after this see it
+// once per frame, or again whenever the camera changes
+void setFrameUniforms(const FrameUniforms& uniforms);
+
+#endif
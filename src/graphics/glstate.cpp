@@ -0,0 +1,94 @@
+#include "glstate.h"
+#include <algorithm>
+
+// never a real name, so the first bind of anything goes through
+const GLuint UNKNOWN_BINDING = 0xFFFFFFFFu;
+
+GLStateCache::GLStateCache() {
+    invalidate();
+}
+
+void GLStateCache::useProgram(GLuint program) {
+    if (this->program == program) {
+        ++counts.programBindsAvoided;
+        return;
+    }
+    glUseProgram(program);
+    this->program = program;
+    ++counts.programBinds;
+}
+
+void GLStateCache::bindVertexArray(GLuint vao) {
+    if (this->vao == vao) {
+        ++counts.vertexArrayBindsAvoided;
+        return;
+    }
+    glBindVertexArray(vao);
+    this->vao = vao;
+    ++counts.vertexArrayBinds;
+}
+
+int GLStateCache::targetIndex(GLenum target) {
+    switch (target) {
+        case GL_TEXTURE_2D: return 0;
+        case GL_TEXTURE_2D_ARRAY: return 1;
+        default: return -1;
+    }
+}
+
+void GLStateCache::bindTexture(int unit, GLenum target, GLuint texture) {
+    // glTexImage and friends act on the active unit, so it follows every bind, even avoided ones
+    if (activeUnit != unit) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        activeUnit = unit;
+    }
+    int index = targetIndex(target);
+    bool cached = unit < UNITS && index >= 0;
+    if (cached && textures[unit][index] == texture) {
+        ++counts.textureBindsAvoided;
+        return;
+    }
+    glBindTexture(target, texture);
+    if (cached) {
+        textures[unit][index] = texture;
+    }
+    ++counts.textureBinds;
+}
+
+void GLStateCache::forgetProgram(GLuint program) {
+    if (this->program == program) {
+        this->program = UNKNOWN_BINDING;
+    }
+}
+
+void GLStateCache::forgetVertexArray(GLuint vao) {
+    if (this->vao == vao) {
+        this->vao = UNKNOWN_BINDING;
+    }
+}
+
+void GLStateCache::forgetTexture(GLuint texture) {
+    for (auto& unit : textures) {
+        std::replace(unit, unit + TARGETS, texture, UNKNOWN_BINDING);
+    }
+}
+
+void GLStateCache::invalidate() {
+    program = UNKNOWN_BINDING;
+    vao = UNKNOWN_BINDING;
+    activeUnit = -1;
+    for (auto& unit : textures) {
+        std::fill(unit, unit + TARGETS, UNKNOWN_BINDING);
+    }
+}
+
+GLStateStats GLStateCache::takeStats() {
+    GLStateStats stats = counts;
+    counts = GLStateStats();
+    return stats;
+}
+
+GLStateCache& glState() {
+    static GLStateCache cache;
+    return cache;
+}
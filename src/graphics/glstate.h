@@ -0,0 +1,50 @@
+#ifndef _GRAPHICS_GLSTATE_H
+#define _GRAPHICS_GLSTATE_H
+#include "graphics.h"
+
+struct GLStateStats {
+    int programBinds = 0;
+    int programBindsAvoided = 0;
+    int vertexArrayBinds = 0;
+    int vertexArrayBindsAvoided = 0;
+    int textureBinds = 0;
+    int textureBindsAvoided = 0;
+};
+
+// remembers what is bound so binding the same thing again costs nothing
+// every program, vertex array and texture bind has to go through here, anything
+// bound behind its back makes the cache wrong
+class GLStateCache {
+public:
+    GLStateCache();
+    void useProgram(GLuint program);
+    void bindVertexArray(GLuint vao);
+    // unit is an index, 0 for GL_TEXTURE0, and is left active afterwards
+    void bindTexture(int unit, GLenum target, GLuint texture);
+    // GL unbinds objects when they are deleted, and a new object can get the same name,
+    // so these have to be called before the matching glDelete
+    void forgetProgram(GLuint program);
+    void forgetVertexArray(GLuint vao);
+    void forgetTexture(GLuint texture);
+    // after a context change or code that binds without the cache
+    void invalidate();
+    // the counts since the last call
+    GLStateStats takeStats();
+private:
+    static const int UNITS = 8;
+    // the only targets the renderers use, anything else is bound every time
+    static const int TARGETS = 2;
+    static int targetIndex(GLenum target);
+
+    GLuint program;
+    GLuint vao;
+    int activeUnit;
+    GLuint textures[UNITS][TARGETS];
+    GLStateStats counts;
+};
+
+// the cache for the one GL context, only used by the thread that has it current:
+// the RenderThread while the game runs, the main thread during startup and shutdown
+GLStateCache& glState();
+
+#endif
@@ -0,0 +1,78 @@
+#include "gputimer.h"
+#include "../profiler.h"
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+namespace {
+
+struct PendingZone {
+    GLuint query;
+    const char* name;
+    uint64_t cpuStart;
+};
+
+struct GpuTimers {
+    std::vector<GLuint> freeQueries;
+    std::vector<GLuint> allQueries;
+    std::deque<PendingZone> pending;
+    PendingZone open = {0, nullptr, 0};
+    int track = -1;
+    uint64_t lastEnd = 0;
+};
+
+GpuTimers timers;
+
+}
+
+void beginGpuZone(const char* name) {
+    if (!profiling() || timers.open.name) {
+        return;
+    }
+    if (timers.freeQueries.empty()) {
+        GLuint query;
+        glGenQueries(1, &query);
+        timers.allQueries.push_back(query);
+        timers.freeQueries.push_back(query);
+    }
+    timers.open = {timers.freeQueries.back(), name, profileNow()};
+    timers.freeQueries.pop_back();
+    glBeginQuery(GL_TIME_ELAPSED, timers.open.query);
+}
+
+void endGpuZone() {
+    if (!timers.open.name) {
+        return;
+    }
+    glEndQuery(GL_TIME_ELAPSED);
+    timers.pending.push_back(timers.open);
+    timers.open = {0, nullptr, 0};
+}
+
+void collectGpuZones() {
+    // queries finish in the order they were issued
+    while (!timers.pending.empty()) {
+        const PendingZone& zone = timers.pending.front();
+        GLint available = 0;
+        glGetQueryObjectiv(zone.query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            break;
+        }
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(zone.query, GL_QUERY_RESULT, &elapsed);
+        if (timers.track < 0) {
+            timers.track = profileTrack("GPU");
+        }
+        // the GPU runs passes one after another, so a pass can't start before the previous one ended
+        uint64_t start = std::max(zone.cpuStart, timers.lastEnd);
+        timers.lastEnd = start + elapsed;
+        recordZone(timers.track, zone.name, start, timers.lastEnd);
+        timers.freeQueries.push_back(zone.query);
+        timers.pending.pop_front();
+    }
+}
+
+void releaseGpuZones() {
+    glDeleteQueries((GLsizei) timers.allQueries.size(), timers.allQueries.data());
+    timers = GpuTimers();
+}
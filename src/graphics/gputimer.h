@@ -0,0 +1,28 @@
+#ifndef _GRAPHICS_GPUTIMER_H
+#define _GRAPHICS_GPUTIMER_H
+#include "graphics.h"
+
+// GL_TIME_ELAPSED queries around render passes while a profile capture runs
+// results are read back frames later by collectGpuZones() without waiting on the GPU,
+// and go on the profiler's "GPU" track starting where the CPU issued them
+// elapsed time queries can't nest, a zone started inside another one is ignored
+void beginGpuZone(const char* name);
+void endGpuZone();
+// call once per frame, before profileFrame()
+void collectGpuZones();
+// deletes the queries, call before the context goes away
+void releaseGpuZones();
+
+class GpuZone {
+public:
+    inline explicit GpuZone(const char* name) {
+        beginGpuZone(name);
+    }
+    inline ~GpuZone() {
+        endGpuZone();
+    }
+    GpuZone(const GpuZone&) = delete;
+    GpuZone& operator=(const GpuZone&) = delete;
+};
+
+#endif
@@ -1,6 +1,51 @@
 #include "graphics.h"
+#include "glstate.h"
+#include <unordered_map>
+
+static std::unordered_map<GLuint, size_t> bufferBytes;
+static std::unordered_map<GLuint, size_t> textureBytes;
+
+static void track(std::unordered_map<GLuint, size_t>& sizes, MemoryTag tag, GLuint name, size_t bytes) {
+    MemoryScope scope(MEMORY_RENDER);
+    auto p = sizes.find(name);
+    if (p != sizes.end()) {
+        trackFree(tag, p->second);
+        p->second = bytes;
+    } else {
+        sizes.insert({name, bytes});
+    }
+    trackAllocation(tag, bytes);
+}
+
+static void untrack(std::unordered_map<GLuint, size_t>& sizes, MemoryTag tag, GLuint name) {
+    auto p = sizes.find(name);
+    if (p != sizes.end()) {
+        trackFree(tag, p->second);
+        sizes.erase(p);
+    }
+}
+
+void trackBuffer(GLuint buffer, size_t bytes) {
+    track(bufferBytes, MEMORY_GPU_BUFFERS, buffer, bytes);
+}
+
+void untrackBuffer(GLuint buffer) {
+    untrack(bufferBytes, MEMORY_GPU_BUFFERS, buffer);
+}
+
+void trackTexture(GLuint texture, size_t bytes) {
+    track(textureBytes, MEMORY_GPU_TEXTURES, texture, bytes);
+}
+
+void untrackTexture(GLuint texture) {
+    untrack(textureBytes, MEMORY_GPU_TEXTURES, texture);
+}
 
 int readShader(const std::string_view& file) {
+    return compileShader(file, readFile(file));
+}
+
+int compileShader(const std::string_view& file, const std::string& shaderSource) {
     int shaderType;
     if (file.substr(file.length() - VERTEX_SHADER_SUFFIX.length()) == VERTEX_SHADER_SUFFIX) {
         shaderType = GL_VERTEX_SHADER;
@@ -11,7 +56,6 @@ int readShader(const std::string_view& file) {
     }
     
     int shader = glCreateShader(shaderType);
-    std::string shaderSource = readFile(file);
     const GLchar* shaderSourcePtr = shaderSource.c_str();
     const GLint shaderSourceLen = shaderSource.length() + 1;
     glShaderSource(shader, 1, &shaderSourcePtr, &shaderSourceLen);
@@ -68,17 +112,20 @@ void checkProgram(int program) {
 }
 
 GLuint makeNearestTexture(const std::string_view& file) {
+    MemoryScope scope(MEMORY_ASSETS);
     GLuint tex;
     int width, height;
     std::vector<GLubyte> textureData = readImage(file, width, height);
     glGenTextures(1, &tex);
-    glBindTexture(GL_TEXTURE_2D, tex);
+    glState().bindTexture(0, GL_TEXTURE_2D, tex);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, textureData.data()); 
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glGenerateMipmap(GL_TEXTURE_2D);
+    // GL_NEAREST never samples mips, so there is no chain to generate
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    trackTexture(tex, (size_t) width * height * 4);
     return tex;
 }
 
@@ -10,22 +10,37 @@
 #include <glm/gtc/type_ptr.hpp>
 #include <vector>
 #include "../util.h"
+#include "../allocations.h"
 
 const std::string VERTEX_SHADER_SUFFIX = "_v.glsl";
 const std::string FRAGMENT_SHADER_SUFFIX = "_f.glsl";
 
 int readShader(const std::string_view& file);
+// file only picks the shader type from its suffix and names it in errors
+int compileShader(const std::string_view& file, const std::string& source);
 void checkProgram(int program);
 GLuint makeNearestTexture(const std::string_view& file);
 
+// GPU memory accounting, keyed by GL object name
+// call trackBuffer after every glBufferData and untrackBuffer before glDeleteBuffers
+void trackBuffer(GLuint buffer, size_t bytes);
+void untrackBuffer(GLuint buffer);
+void trackTexture(GLuint texture, size_t bytes);
+void untrackTexture(GLuint texture);
+
 enum ATTRIB_TYPE : GLint {
     ATTRIB_POSITION = 0,
     ATTRIB_TEXTURE = 1,
-    ATTRIB_NORMAL = 2
+    ATTRIB_NORMAL = 2,
+    ATTRIB_COLOR = 3,
+    ATTRIB_INSTANCE_OFFSET = 4,
+    ATTRIB_INSTANCE_SCALE = 5,
+    ATTRIB_INSTANCE_FRAME = 6,
+    ATTRIB_INSTANCE_COLOR = 7
 };
 
 enum UNIFORM_TYPE : GLint {
-    UNIFORM_MATRIX, UNIFORM_COLOR, UNIFORM_SAMPLER
+    UNIFORM_TRANSFORM, UNIFORM_COLOR, UNIFORM_SAMPLER
 };
 
 #endif
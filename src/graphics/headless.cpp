@@ -0,0 +1,144 @@
+#include "headless.h"
+#include "stream.h"
+#include "glstate.h"
+#include "../util.h"
+#include <string>
+#include <vector>
+#ifdef HEADLESS_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+#ifdef HEADLESS_EGL
+
+static std::string eglErrorString(const char* what) {
+    char code[16];
+    snprintf(code, sizeof(code), "0x%04x", eglGetError());
+    return std::string(what) + " failed, EGL error " + code;
+}
+
+HeadlessContext::HeadlessContext(int width, int height) : framebufferWidth(width), framebufferHeight(height) {
+    // the surfaceless platform doesn't go through X or Wayland at all
+    auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress("eglGetPlatformDisplayEXT");
+    EGLDisplay eglDisplay = getPlatformDisplay ? getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr) : EGL_NO_DISPLAY;
+    if (eglDisplay == EGL_NO_DISPLAY) {
+        eglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+    EGLint major, minor;
+    if (eglDisplay == EGL_NO_DISPLAY || !eglInitialize(eglDisplay, &major, &minor)) {
+        throw std::runtime_error(eglErrorString("eglInitialize"));
+    }
+    display = eglDisplay;
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        release();
+        throw std::runtime_error(eglErrorString("eglBindAPI"));
+    }
+    // there is no surface to match, so any config will do, or none where the driver allows it
+    const EGLint configAttribs[] = {EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE};
+    EGLConfig config = nullptr;
+    EGLint configCount = 0;
+    eglChooseConfig(eglDisplay, configAttribs, &config, 1, &configCount);
+    if (configCount == 0) {
+        config = nullptr;
+    }
+    // the same version and profile as the window, glad is generated for 4.3 compatibility
+    const EGLint contextAttribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 4,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_COMPATIBILITY_PROFILE_BIT,
+        EGL_NONE
+    };
+    EGLContext eglContext = eglCreateContext(eglDisplay, config, EGL_NO_CONTEXT, contextAttribs);
+    if (eglContext == EGL_NO_CONTEXT) {
+        release();
+        throw std::runtime_error(eglErrorString("eglCreateContext"));
+    }
+    context = eglContext;
+    if (!eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, eglContext)) {
+        release();
+        throw std::runtime_error(eglErrorString("eglMakeCurrent"));
+    }
+    gladLoadGLLoader((GLADloadproc) eglGetProcAddress);
+    loadBufferStorage((GLADloadproc) eglGetProcAddress);
+
+    // a texture rather than a renderbuffer, so it is counted with the other textures
+    glGenTextures(1, &colorTexture);
+    glState().bindTexture(0, GL_TEXTURE_2D, colorTexture);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, width, height);
+    trackTexture(colorTexture, (size_t) width * height * 4);
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        release();
+        throw std::runtime_error("Headless framebuffer is incomplete");
+    }
+    glViewport(0, 0, width, height);
+}
+
+HeadlessContext::~HeadlessContext() {
+    release();
+}
+
+// also used to clean up when the constructor fails part way
+void HeadlessContext::release() {
+    if (colorTexture != 0) {
+        untrackTexture(colorTexture);
+        glState().forgetTexture(colorTexture);
+        glDeleteTextures(1, &colorTexture);
+    }
+    if (framebuffer != 0) {
+        glDeleteFramebuffers(1, &framebuffer);
+    }
+    if (context != nullptr) {
+        eglMakeCurrent((EGLDisplay) display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext((EGLDisplay) display, (EGLContext) context);
+    }
+    if (display != nullptr) {
+        eglTerminate((EGLDisplay) display);
+    }
+    framebuffer = 0;
+    colorTexture = 0;
+    context = nullptr;
+    display = nullptr;
+}
+
+void HeadlessContext::bind() {
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(0, 0, framebufferWidth, framebufferHeight);
+}
+
+void HeadlessContext::makeCurrent() {
+    if (!eglMakeCurrent((EGLDisplay) display, EGL_NO_SURFACE, EGL_NO_SURFACE, (EGLContext) context)) {
+        throw std::runtime_error(eglErrorString("eglMakeCurrent"));
+    }
+}
+
+void HeadlessContext::releaseCurrent() {
+    eglMakeCurrent((EGLDisplay) display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+}
+
+#else
+
+HeadlessContext::HeadlessContext(int width, int height) : framebufferWidth(width), framebufferHeight(height) {
+    throw std::runtime_error("Built without EGL, there is no headless context");
+}
+
+HeadlessContext::~HeadlessContext() {}
+
+void HeadlessContext::release() {}
+
+void HeadlessContext::bind() {}
+
+void HeadlessContext::makeCurrent() {}
+
+void HeadlessContext::releaseCurrent() {}
+
+#endif
+
+uint64_t framebufferChecksum(int width, int height) {
+    std::vector<GLubyte> pixels((size_t) width * height * 4);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    return hashBytes(FNV_OFFSET, std::string_view((const char*) pixels.data(), pixels.size()));
+}
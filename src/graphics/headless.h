@@ -0,0 +1,42 @@
+#ifndef _GRAPHICS_HEADLESS_H
+#define _GRAPHICS_HEADLESS_H
+#include "graphics.h"
+#include <cstdint>
+
+// an OpenGL 4.3 context with no window, drawing into its own framebuffer object
+// made on EGL's surfaceless platform, so it needs no display server and runs on
+// Mesa's software rasterizer on a machine without a GPU
+// only available when built with EGL (HEADLESS_EGL), otherwise the constructor throws
+class HeadlessContext {
+public:
+    HeadlessContext(int width, int height);
+    ~HeadlessContext();
+    HeadlessContext(const HeadlessContext&) = delete;
+    HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+    // binds the offscreen framebuffer, the constructor leaves it bound
+    void bind();
+    // the constructor leaves the context current on the calling thread, these move it to another one
+    void makeCurrent();
+    void releaseCurrent();
+    inline int width() const {
+        return framebufferWidth;
+    }
+    inline int height() const {
+        return framebufferHeight;
+    }
+private:
+    void release();
+    // EGLDisplay and EGLContext, kept opaque so this header doesn't pull in EGL
+    void* display = nullptr;
+    void* context = nullptr;
+    GLuint framebuffer = 0;
+    GLuint colorTexture = 0;
+    int framebufferWidth, framebufferHeight;
+};
+
+// reads back the bound framebuffer's color and hashes it, equal hashes mean equal pixels
+// waits for rendering to finish, so only call it outside of anything being timed
+uint64_t framebufferChecksum(int width, int height);
+
+#endif
@@ -0,0 +1,199 @@
+#include "program.h"
+#include "glstate.h"
+#include "frameuniforms.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+
+// every attribute name used by the shaders in res/ and the location it is bound to
+static const std::pair<ATTRIB_TYPE, const char*> ATTRIB_NAMES[] = {
+    {ATTRIB_POSITION, "position"},
+    {ATTRIB_TEXTURE, "texture"},
+    {ATTRIB_NORMAL, "normal"},
+    {ATTRIB_COLOR, "color"},
+    {ATTRIB_INSTANCE_OFFSET, "instanceOffset"},
+    {ATTRIB_INSTANCE_SCALE, "instanceScale"},
+    {ATTRIB_INSTANCE_FRAME, "instanceFrame"},
+    {ATTRIB_INSTANCE_COLOR, "instanceColor"},
+};
+
+static std::map<std::pair<std::string, std::string>, ShaderProgram> programs;
+static ProgramCacheStats cacheStats;
+
+const uint32_t PROGRAM_BINARY_MAGIC = 0x42475250; // "PRGB"
+
+struct ProgramBinaryHeader {
+    uint32_t magic;
+    uint32_t format;
+    uint64_t key;
+    uint32_t length;
+};
+
+// anything that changes the compiled program has to be part of the key
+static uint64_t programKey(const std::string& vertexSource, const std::string& fragmentSource) {
+    uint64_t hash = FNV_OFFSET;
+    hash = hashBytes(hash, vertexSource);
+    hash = hashBytes(hash, fragmentSource);
+    for (GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION}) {
+        const GLubyte* value = glGetString(name);
+        hash = hashBytes(hash, value ? (const char*) value : "");
+    }
+    for (const auto& attrib : ATTRIB_NAMES) {
+        hash = hashBytes(hash, std::to_string(attrib.first) + attrib.second);
+    }
+    return hash;
+}
+
+static std::filesystem::path binaryPath(uint64_t key) {
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long) key);
+    return std::filesystem::path(PROGRAM_CACHE_DIRECTORY) / name;
+}
+
+// returns 0 if there is no usable binary
+static GLuint loadBinary(uint64_t key) {
+    std::ifstream file(binaryPath(key), std::ios::binary);
+    if (!file) {
+        return 0;
+    }
+    ProgramBinaryHeader header;
+    if (!file.read((char*) &header, sizeof(header)) || header.magic != PROGRAM_BINARY_MAGIC || header.key != key) {
+        return 0;
+    }
+    std::vector<char> data(header.length);
+    if (!file.read(data.data(), data.size())) {
+        return 0;
+    }
+    GLuint id = glCreateProgram();
+    glProgramBinary(id, header.format, data.data(), (GLsizei) data.size());
+    GLint linkStatus;
+    glGetProgramiv(id, GL_LINK_STATUS, &linkStatus);
+    if (linkStatus != GL_TRUE) {
+        // usually a driver update
+        glDeleteProgram(id);
+        ++cacheStats.binaryRejected;
+        return 0;
+    }
+    return id;
+}
+
+// failing to write the cache only costs a compile next time, so errors are ignored
+static void saveBinary(GLuint id, uint64_t key) {
+    GLint length = 0;
+    glGetProgramiv(id, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return;
+    }
+    std::vector<char> data(length);
+    GLenum format;
+    glGetProgramBinary(id, length, &length, &format, data.data());
+    std::error_code error;
+    std::filesystem::create_directories(PROGRAM_CACHE_DIRECTORY, error);
+    std::ofstream file(binaryPath(key), std::ios::binary | std::ios::trunc);
+    ProgramBinaryHeader header = {PROGRAM_BINARY_MAGIC, format, key, (uint32_t) length};
+    file.write((const char*) &header, sizeof(header));
+    file.write(data.data(), length);
+}
+
+static GLuint compileProgram(const std::string& vertexFile, const std::string& vertexSource,
+        const std::string& fragmentFile, const std::string& fragmentSource) {
+    GLint vshader = compileShader(vertexFile, vertexSource);
+    GLint fshader = compileShader(fragmentFile, fragmentSource);
+    GLuint id = glCreateProgram();
+    glAttachShader(id, vshader);
+    glAttachShader(id, fshader);
+    for (const auto& attrib : ATTRIB_NAMES) {
+        glBindAttribLocation(id, attrib.first, attrib.second);
+    }
+    glProgramParameteri(id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glLinkProgram(id);
+    glDeleteShader(vshader);
+    glDeleteShader(fshader);
+    try {
+        checkProgram(id);
+    } catch (...) {
+        glDeleteProgram(id);
+        throw;
+    }
+    ++cacheStats.compiled;
+    return id;
+}
+
+static bool binariesSupported() {
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    return formats > 0;
+}
+
+const ProgramCacheStats& programCacheStats() {
+    return cacheStats;
+}
+
+GLint ShaderProgram::uniform(std::string_view name) const {
+    auto p = uniforms.find(name);
+    return p == uniforms.end() ? -1 : p->second;
+}
+
+static void readUniforms(ShaderProgram& program) {
+    GLint count = 0, maxLength = 0;
+    glGetProgramiv(program.id, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(program.id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    std::string name(maxLength, '\0');
+    for (GLint i = 0; i < count; ++i) {
+        GLsizei length;
+        GLint size;
+        GLenum type;
+        glGetActiveUniform(program.id, i, maxLength, &length, &size, &type, name.data());
+        std::string uniformName(name.data(), length);
+        // arrays are reported as "name[0]"
+        if (uniformName.ends_with("[0]")) {
+            uniformName.resize(uniformName.length() - 3);
+        }
+        program.uniforms.insert({uniformName, glGetUniformLocation(program.id, uniformName.c_str())});
+    }
+}
+
+const ShaderProgram& loadProgram(const std::string& vertexFile, const std::string& fragmentFile) {
+    auto key = std::make_pair(vertexFile, fragmentFile);
+    auto p = programs.find(key);
+    if (p != programs.end()) {
+        return p->second;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::string vertexSource = readFile(vertexFile);
+    std::string fragmentSource = readFile(fragmentFile);
+    static const bool useBinaries = binariesSupported();
+    uint64_t binaryKey = programKey(vertexSource, fragmentSource);
+    GLuint id = useBinaries ? loadBinary(binaryKey) : 0;
+    if (id != 0) {
+        ++cacheStats.binaryLoads;
+    } else {
+        id = compileProgram(vertexFile, vertexSource, fragmentFile, fragmentSource);
+        if (useBinaries) {
+            saveBinary(id, binaryKey);
+        }
+    }
+
+    // linking resets block bindings, loading a binary included
+    GLuint frameBlock = glGetUniformBlockIndex(id, "Frame");
+    if (frameBlock != GL_INVALID_INDEX) {
+        glUniformBlockBinding(id, frameBlock, FRAME_UNIFORM_BINDING);
+    }
+
+    ShaderProgram& program = programs[key];
+    program.id = id;
+    readUniforms(program);
+    cacheStats.milliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return program;
+}
+
+void releasePrograms() {
+    for (const auto& p : programs) {
+        glState().forgetProgram(p.second.id);
+        glDeleteProgram(p.second.id);
+    }
+    programs.clear();
+}
@@ -0,0 +1,36 @@
+#ifndef _GRAPHICS_PROGRAM_H
+#define _GRAPHICS_PROGRAM_H
+#include "graphics.h"
+#include <map>
+#include <string>
+
+// a linked program with every active uniform's location looked up once at link time
+struct ShaderProgram {
+    GLuint id;
+    std::map<std::string, GLint, std::less<>> uniforms;
+    // -1 for a uniform the program doesn't have, same as glGetUniformLocation
+    GLint uniform(std::string_view name) const;
+};
+
+// compiles and links a vertex + fragment shader pair the first time it is asked for,
+// after that every renderer using the same pair shares the same program
+// attributes are bound to their ATTRIB_TYPE locations by name before linking
+const ShaderProgram& loadProgram(const std::string& vertexFile, const std::string& fragmentFile);
+// deletes every cached program, call while the context is still current
+void releasePrograms();
+
+// linked programs are also saved to disk with glGetProgramBinary, keyed by a hash of the
+// sources and the driver, so later runs can skip compiling. a binary the driver rejects
+// is compiled from source again and replaced
+const std::string PROGRAM_CACHE_DIRECTORY = "shadercache";
+
+struct ProgramCacheStats {
+    int binaryLoads = 0;
+    int binaryRejected = 0;
+    int compiled = 0;
+    double milliseconds = 0.0;
+};
+
+const ProgramCacheStats& programCacheStats();
+
+#endif
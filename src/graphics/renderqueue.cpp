@@ -0,0 +1,79 @@
+#include "renderqueue.h"
+#include "gputimer.h"
+#include "../profiler.h"
+
+const int RENDER_KEY_PROGRAM_BITS = 12;
+const int RENDER_KEY_TEXTURE_BITS = 20;
+const int RENDER_KEY_DEPTH_BITS = 24;
+const size_t RENDER_QUEUE_ARENA_SIZE = 1 << 20;
+
+uint64_t renderKey(int layer, GLuint program, GLuint texture, uint32_t depth) {
+    uint64_t key = (uint64_t) (layer & 0xFF);
+    key = (key << RENDER_KEY_PROGRAM_BITS) | (program & ((1u << RENDER_KEY_PROGRAM_BITS) - 1));
+    key = (key << RENDER_KEY_TEXTURE_BITS) | (texture & ((1u << RENDER_KEY_TEXTURE_BITS) - 1));
+    key = (key << RENDER_KEY_DEPTH_BITS) | (depth & ((1u << RENDER_KEY_DEPTH_BITS) - 1));
+    return key;
+}
+
+RenderQueue::RenderQueue() : arena(RENDER_QUEUE_ARENA_SIZE) {}
+
+int RenderQueue::execute() {
+    size_t count = commands.size();
+    sorted.resize(count);
+    // least significant digit radix sort a byte at a time, skipping bytes every key shares
+    for (int shift = 0; shift < 64; shift += 8) {
+        size_t histogram[256] = {};
+        for (const Command& command : commands) {
+            ++histogram[(command.key >> shift) & 0xFF];
+        }
+        if (count == 0 || histogram[(commands[0].key >> shift) & 0xFF] == count) {
+            continue;
+        }
+        size_t offset = 0;
+        for (size_t& bucket : histogram) {
+            size_t size = bucket;
+            bucket = offset;
+            offset += size;
+        }
+        for (const Command& command : commands) {
+            sorted[histogram[(command.key >> shift) & 0xFF]++] = command;
+        }
+        commands.swap(sorted);
+    }
+    if (!profiling()) {
+        for (const Command& command : commands) {
+            command.run(command.closure);
+        }
+    } else {
+        const char* pass = nullptr;
+        int layer = -1;
+        uint64_t passStart = 0;
+        for (const Command& command : commands) {
+            int commandLayer = (int) (command.key >> (RENDER_KEY_PROGRAM_BITS + RENDER_KEY_TEXTURE_BITS + RENDER_KEY_DEPTH_BITS));
+            if (commandLayer != layer) {
+                if (pass) {
+                    endGpuZone();
+                    recordZone(pass, passStart, profileNow());
+                }
+                layer = commandLayer;
+                pass = layerNames[layer];
+                if (pass) {
+                    passStart = profileNow();
+                    beginGpuZone(pass);
+                }
+            }
+            command.run(command.closure);
+        }
+        if (pass) {
+            endGpuZone();
+            recordZone(pass, passStart, profileNow());
+        }
+    }
+    commands.clear();
+    arena.reset();
+    return (int) count;
+}
+
+void RenderQueue::nameLayer(int layer, const char* name) {
+    layerNames[layer & 0xFF] = name;
+}
@@ -0,0 +1,60 @@
+#ifndef _GRAPHICS_RENDERQUEUE_H
+#define _GRAPHICS_RENDERQUEUE_H
+#include "graphics.h"
+#include "../scratch.h"
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+// most significant first: layer 8 bits, program 12, texture 20, depth 24
+// layers keep their order, inside a layer draws with the same program and then the same texture end up together
+uint64_t renderKey(int layer, GLuint program, GLuint texture, uint32_t depth = 0);
+
+// draws are submitted with a sort key and run in key order by execute()
+// the sort is stable, so draws with equal keys run in the order they were submitted
+// commands and whatever they copy live in the queue's own arena until execute() is done with them,
+// so a queue can be recorded on one thread and executed on another
+class RenderQueue {
+public:
+    RenderQueue();
+    // draw is copied into the queue's arena, so it must not own anything that needs destroying
+    template <typename F>
+    void submit(uint64_t key, F draw) {
+        static_assert(std::is_trivially_destructible_v<F>, "render commands are never destroyed");
+        void* closure = new (arena.allocate(sizeof(F), alignof(F))) F(std::move(draw));
+        commands.push_back({key, [](void* closure) { (*static_cast<F*>(closure))(); }, closure});
+    }
+    // for data a command draws after the recording side has moved on and reused its own buffers
+    template <typename T>
+    std::span<const T> copy(std::span<const T> data) {
+        static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>, "copies are never destroyed");
+        T* copied = static_cast<T*>(arena.allocate(data.size_bytes(), alignof(T)));
+        if (!data.empty()) {
+            std::memcpy(copied, data.data(), data.size_bytes());
+        }
+        return std::span<const T>(copied, data.size());
+    }
+    // freed after the next execute()
+    inline std::pmr::memory_resource& memory() {
+        return arena;
+    }
+    // sorts and runs everything submitted since the last execute, returns how many commands ran
+    int execute();
+    // named layers are profiled as render passes, with a CPU zone and a GPU timer each
+    void nameLayer(int layer, const char* name);
+private:
+    struct Command {
+        uint64_t key;
+        void (*run)(void* closure);
+        void* closure;
+    };
+    std::vector<Command> commands;
+    std::vector<Command> sorted;
+    ScratchArena arena;
+    const char* layerNames[256] = {};
+};
+
+#endif
@@ -1,23 +1,15 @@
 #include "simple.h"
+#include "program.h"
+#include "glstate.h"
 
 SimpleRender::SimpleRender() {
-    GLint vshader = readShader("res/simple_v.glsl");
-    GLint fshader = readShader("res/simple_f.glsl");
-    GLint program = glCreateProgram();
-    glAttachShader(program, vshader);
-    glAttachShader(program, fshader);
-    glBindAttribLocation(program, ATTRIB_POSITION, "position");
-    glLinkProgram(program);
-    checkProgram(program);
-    uniforms.insert({UNIFORM_MATRIX, glGetUniformLocation(program, "matrix")});
-    uniforms.insert({UNIFORM_COLOR, glGetUniformLocation(program, "color")});
-
-    glDeleteShader(vshader);
-    glDeleteShader(fshader);
+    const ShaderProgram& program = loadProgram("res/simple_v.glsl", "res/simple_f.glsl");
+    uniforms.insert({UNIFORM_TRANSFORM, program.uniform("transform")});
+    uniforms.insert({UNIFORM_COLOR, program.uniform("color")});
 
     GLuint vao;
     glGenVertexArrays(1, &vao);
-    glBindVertexArray(vao);
+    glState().bindVertexArray(vao);
 
     GLfloat data[] = {
         -0.5f, -0.5f,
@@ -31,26 +23,28 @@ SimpleRender::SimpleRender() {
     glGenBuffers(1, &vbo);
     glBindBuffer(GL_ARRAY_BUFFER, vbo);
     glBufferData(GL_ARRAY_BUFFER, sizeof(data), data, GL_STATIC_DRAW);
+    trackBuffer(vbo, sizeof(data));
 
     glEnableVertexAttribArray(ATTRIB_POSITION);
     glVertexAttribPointer(ATTRIB_POSITION, 2, GL_FLOAT, false, 2 * sizeof(GLfloat), (void*) 0);
 
     shared = std::shared_ptr<Shared>(new Shared());
-    shared->program = program;
+    shared->program = program.id;
     shared->vao = vao;
     shared->vbo = vbo;
 }
 
-void SimpleRender::render(glm::mat4 matrix, glm::vec4 color) {
-    glUseProgram(shared->program);
-    glUniformMatrix4fv(uniforms[UNIFORM_MATRIX], 1, false, glm::value_ptr(matrix));
+void SimpleRender::render(glm::vec2 position, glm::vec2 scale, glm::vec4 color) {
+    glState().useProgram(shared->program);
+    glUniform4f(uniforms[UNIFORM_TRANSFORM], position.x, position.y, scale.x, scale.y);
     glUniform4f(uniforms[UNIFORM_COLOR], color.x, color.y, color.z, color.w);
-    glBindVertexArray(shared->vao);
+    glState().bindVertexArray(shared->vao);
     glDrawArrays(GL_TRIANGLES, 0, 6);
 }
 
 SimpleRender::Shared::~Shared() {
-    glDeleteProgram(program);
+    untrackBuffer(vbo);
     glDeleteBuffers(1, &vbo);
+    glState().forgetVertexArray(vao);
     glDeleteVertexArrays(1, &vao);
 }
@@ -7,7 +7,8 @@
 class SimpleRender {
 public:
     SimpleRender();
-    void render(glm::mat4 matrix, glm::vec4 color);
+    // the quad is centered on position, the view projection comes from setFrameUniforms()
+    void render(glm::vec2 position, glm::vec2 scale, glm::vec4 color);
 private:
     struct Shared {
         GLint program;
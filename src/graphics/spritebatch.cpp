@@ -0,0 +1,141 @@
+#include "spritebatch.h"
+#include "program.h"
+#include "glstate.h"
+#include "stream.h"
+#include "../scratch.h"
+#include <algorithm>
+#include <cmath>
+
+const size_t SPRITE_BATCH_INITIAL_QUADS = 1024;
+
+SpriteBatch::SpriteBatch() {
+    const ShaderProgram& program = loadProgram("res/batch_v.glsl", "res/batch_f.glsl");
+    uniformSampler = program.uniform("sampler");
+
+    GLuint vao;
+    glGenVertexArrays(1, &vao);
+    glState().bindVertexArray(vao);
+
+    // vertices are written into frameStream() every frame, only the indices live here
+    GLuint ibo;
+    glGenBuffers(1, &ibo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+    glEnableVertexAttribArray(ATTRIB_POSITION);
+    glEnableVertexAttribArray(ATTRIB_TEXTURE);
+    glEnableVertexAttribArray(ATTRIB_COLOR);
+
+    shared = std::shared_ptr<Shared>(new Shared());
+    shared->program = program.id;
+    shared->ibo = ibo;
+    shared->vao = vao;
+    reserve(SPRITE_BATCH_INITIAL_QUADS);
+}
+
+// grows the index buffer, it never changes after this
+void SpriteBatch::reserve(size_t quadCount) {
+    if (quadCount <= shared->capacity) {
+        return;
+    }
+    size_t capacity = std::max(shared->capacity * 2, quadCount);
+    std::vector<GLuint> indices(capacity * 6);
+    for (size_t i = 0; i < capacity; ++i) {
+        GLuint first = (GLuint) i * 4;
+        GLuint quad[] = {first + 0, first + 1, first + 2, first + 2, first + 3, first + 0};
+        std::copy(quad, quad + 6, indices.begin() + i * 6);
+    }
+    glState().bindVertexArray(shared->vao);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, shared->ibo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+    trackBuffer(shared->ibo, indices.size() * sizeof(GLuint));
+    shared->capacity = capacity;
+}
+
+void SpriteBatch::begin() {
+    vertices.clear();
+    quads.clear();
+}
+
+void SpriteBatch::draw(int layer, GLuint texture, glm::vec2 center, glm::vec2 scale, SpritesheetSpec spec, glm::vec4 color, float angle) {
+    // same corners and texture coordinates as the quads in SpritesheetRender
+    const glm::vec2 corners[4] = {{-0.5f, -0.5f}, {-0.5f, +0.5f}, {+0.5f, +0.5f}, {+0.5f, -0.5f}};
+    const glm::vec2 uvs[4] = {spec.min, {spec.min.x, spec.max.y}, spec.max, {spec.max.x, spec.min.y}};
+    float c = 1.0f, s = 0.0f;
+    if (angle != 0.0f) {
+        c = std::cos(angle);
+        s = std::sin(angle);
+    }
+    GLubyte r = (GLubyte) (constrain(color.x, 0.0f, 1.0f) * 255.0f + 0.5f);
+    GLubyte g = (GLubyte) (constrain(color.y, 0.0f, 1.0f) * 255.0f + 0.5f);
+    GLubyte b = (GLubyte) (constrain(color.z, 0.0f, 1.0f) * 255.0f + 0.5f);
+    GLubyte a = (GLubyte) (constrain(color.w, 0.0f, 1.0f) * 255.0f + 0.5f);
+    for (int i = 0; i < 4; ++i) {
+        glm::vec2 p = corners[i] * scale;
+        vertices.push_back({
+            center.x + p.x * c - p.y * s, center.y + p.x * s + p.y * c,
+            uvs[i].x, uvs[i].y,
+            r, g, b, a
+        });
+    }
+    uint64_t key = ((uint64_t) ((uint32_t) layer ^ 0x80000000u) << 32) | texture;
+    quads.push_back({key, (uint32_t) quads.size()});
+}
+
+void SpriteBatch::end() {
+    draw(prepare(frameScratch()));
+}
+
+SpriteBatch::Prepared SpriteBatch::prepare(std::pmr::memory_resource& memory) {
+    std::sort(quads.begin(), quads.end());
+    Vertex* sorted = static_cast<Vertex*>(memory.allocate(quads.size() * 4 * sizeof(Vertex), alignof(Vertex)));
+    size_t runCount = 0;
+    for (size_t i = 0; i < quads.size(); ++i) {
+        std::copy_n(this->vertices.begin() + quads[i].index * 4, 4, sorted + i * 4);
+        if (i == 0 || quads[i].key != quads[i - 1].key) {
+            ++runCount;
+        }
+    }
+    Run* runs = static_cast<Run*>(memory.allocate(runCount * sizeof(Run), alignof(Run)));
+    size_t run = 0;
+    for (size_t i = 0; i < quads.size(); ++i) {
+        if (i == 0 || quads[i].key != quads[i - 1].key) {
+            runs[run++] = {(GLuint) (quads[i].key & 0xFFFFFFFFu), 0};
+        }
+        ++runs[run - 1].quads;
+    }
+    return {std::span<const Vertex>(sorted, quads.size() * 4), std::span<const Run>(runs, runCount)};
+}
+
+void SpriteBatch::draw(const Prepared& prepared) {
+    size_t quadCount = prepared.vertices.size() / 4;
+    lastStats = SpriteBatchStats();
+    lastStats.sprites = (int) quadCount;
+    if (quadCount == 0) {
+        return;
+    }
+    reserve(quadCount);
+
+    glState().useProgram(shared->program);
+    glUniform1i(uniformSampler, 0);
+    StreamAllocation vertices = frameStream().write(prepared.vertices);
+    glState().bindVertexArray(shared->vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vertices.buffer);
+    const char* base = (const char*) vertices.offset;
+    glVertexAttribPointer(ATTRIB_POSITION, 2, GL_FLOAT, false, sizeof(Vertex), base + offsetof(Vertex, x));
+    glVertexAttribPointer(ATTRIB_TEXTURE, 2, GL_FLOAT, false, sizeof(Vertex), base + offsetof(Vertex, u));
+    glVertexAttribPointer(ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, true, sizeof(Vertex), base + offsetof(Vertex, r));
+
+    size_t first = 0;
+    for (const Run& run : prepared.runs) {
+        glState().bindTexture(0, GL_TEXTURE_2D, run.texture);
+        glDrawElements(GL_TRIANGLES, (GLsizei) (run.quads * 6), GL_UNSIGNED_INT, (void*) (first * 6 * sizeof(GLuint)));
+        ++lastStats.drawCalls;
+        first += run.quads;
+    }
+}
+
+SpriteBatch::Shared::~Shared() {
+    untrackBuffer(ibo);
+    glDeleteBuffers(1, &ibo);
+    glState().forgetVertexArray(vao);
+    glDeleteVertexArrays(1, &vao);
+}
@@ -0,0 +1,80 @@
+#ifndef _GRAPHICS_SPRITEBATCH_H
+#define _GRAPHICS_SPRITEBATCH_H
+#include "graphics.h"
+#include "spritesheet.h"
+#include <memory>
+#include <memory_resource>
+#include <span>
+#include <vector>
+#include <cstdint>
+
+struct SpriteBatchStats {
+    int sprites = 0;
+    int drawCalls = 0;
+};
+
+// collects textured quads between begin() and end(), then draws them sorted by
+// (layer, texture) with one draw call per run of the same texture
+// quads in the same layer and texture keep the order they were drawn in
+class SpriteBatch {
+public:
+    struct Vertex {
+        GLfloat x, y;
+        GLfloat u, v;
+        GLubyte r, g, b, a;
+    };
+    // consecutive quads with the same texture, one draw call each
+    struct Run {
+        GLuint texture;
+        uint32_t quads;
+    };
+    // the sorted quads end() draws, ready to be copied into the stream buffer
+    struct Prepared {
+        std::span<const Vertex> vertices;
+        std::span<const Run> runs;
+    };
+
+    SpriteBatch();
+    // the view projection comes from setFrameUniforms()
+    void begin();
+    void draw(int layer, GLuint texture, glm::vec2 center, glm::vec2 scale, SpritesheetSpec spec, glm::vec4 color, float angle = 0.0f);
+    // prepare() and then draw()
+    void end();
+    // sorts everything drawn since begin() into memory without touching GL,
+    // so a frame can be prepared on one thread and drawn by the thread with the context
+    Prepared prepare(std::pmr::memory_resource& memory);
+    void draw(const Prepared& prepared);
+    // for render queue sort keys
+    inline GLuint program() const {
+        return (GLuint) shared->program;
+    }
+    inline const SpriteBatchStats& stats() const {
+        return lastStats;
+    }
+private:
+    struct Quad {
+        uint64_t key;
+        uint32_t index;
+        inline bool operator<(const Quad& other) const {
+            return key == other.key ? index < other.index : key < other.key;
+        }
+    };
+    void reserve(size_t quadCount);
+
+    // Shared is used so that Renders can be copied and still work just fine
+    struct Shared {
+        GLint program;
+        GLuint ibo;
+        GLuint vao;
+        size_t capacity = 0;
+        ~Shared();
+    };
+    std::shared_ptr<Shared> shared;
+    GLint uniformSampler;
+
+    std::vector<Vertex> vertices;
+    std::vector<Quad> quads;
+    SpriteBatchStats lastStats;
+};
+
+#endif
@@ -1,5 +1,8 @@
 #include "spritesheet.h"
-#include "graphics.h"
+#include "program.h"
+#include "glstate.h"
+#include "stream.h"
+#include <cstddef>
 
 SpritesheetSpec textureGrid(int sheetWidth, int sheetHeight, int index) {
     float tileWidth = 1.0f / sheetWidth;
@@ -12,28 +15,19 @@ SpritesheetSpec textureGrid(int sheetWidth, int sheetHeight, int index) {
     };
 }
 
-SpritesheetRender::SpritesheetRender() {
-    GLint vshader = readShader("res/spritesheet_v.glsl");
-    GLint fshader = readShader("res/texture_f.glsl");
-    GLint program = glCreateProgram();
-    glAttachShader(program, vshader);
-    glAttachShader(program, fshader);
-    glBindAttribLocation(program, ATTRIB_POSITION, "position");
-    glBindAttribLocation(program, ATTRIB_TEXTURE, "texture");
-    glLinkProgram(program);
-    checkProgram(program);
-    uniformMatrix = glGetUniformLocation(program, "matrix");
-    uniformSampler = glGetUniformLocation(program, "sampler");
-    uniformColor = glGetUniformLocation(program, "color");
-    uniformMin = glGetUniformLocation(program, "min");
-    uniformMax = glGetUniformLocation(program, "max");
+SpritesheetSpec textureGrid(const SpritesheetSpec& region, int sheetWidth, int sheetHeight, int index) {
+    SpritesheetSpec frame = textureGrid(sheetWidth, sheetHeight, index);
+    glm::vec2 size = region.max - region.min;
+    return {region.min + frame.min * size, region.min + frame.max * size};
+}
 
-    glDeleteShader(vshader);
-    glDeleteShader(fshader);
+SpritesheetRender::SpritesheetRender() {
+    const ShaderProgram& program = loadProgram("res/spritesheet_v.glsl", "res/batch_f.glsl");
+    uniformSampler = program.uniform("sampler");
 
     GLuint vao;
     glGenVertexArrays(1, &vao);
-    glBindVertexArray(vao);
+    glState().bindVertexArray(vao);
 
     GLfloat data[] = {
         -0.5f, -0.5f, 0.0f, 0.0f,
@@ -47,32 +41,51 @@ SpritesheetRender::SpritesheetRender() {
     glGenBuffers(1, &vbo);
     glBindBuffer(GL_ARRAY_BUFFER, vbo);
     glBufferData(GL_ARRAY_BUFFER, sizeof(data), data, GL_STATIC_DRAW);
+    trackBuffer(vbo, sizeof(data));
 
     glEnableVertexAttribArray(ATTRIB_POSITION);
     glVertexAttribPointer(ATTRIB_POSITION, 2, GL_FLOAT, false, 4 * sizeof(GLfloat), (void*) 0);
     glEnableVertexAttribArray(ATTRIB_TEXTURE);
     glVertexAttribPointer(ATTRIB_TEXTURE, 2, GL_FLOAT, false, 4 * sizeof(GLfloat), (void*) (2 * sizeof(GLfloat)));
 
+    // per instance attributes, pointed at this draw's instances in frameStream()
+    for (GLint attrib : {ATTRIB_INSTANCE_OFFSET, ATTRIB_INSTANCE_SCALE, ATTRIB_INSTANCE_FRAME, ATTRIB_INSTANCE_COLOR}) {
+        glEnableVertexAttribArray(attrib);
+        glVertexAttribDivisor(attrib, 1);
+    }
+
     shared = std::shared_ptr<Shared>(new Shared());
-    shared->program = program;
+    shared->program = program.id;
     shared->vbo = vbo;
     shared->vao = vao;
 }
 
-void SpritesheetRender::render(glm::mat4 matrix, glm::vec4 color, GLint sampler, SpritesheetSpec spec) {
-    glUseProgram(shared->program);
-    glUniformMatrix4fv(uniformMatrix, 1, false, glm::value_ptr(matrix));
-    glUniform4f(uniformColor, color.x, color.y, color.z, color.w);
+void SpritesheetRender::render(glm::vec2 position, glm::vec2 scale, glm::vec4 color, GLint sampler, SpritesheetSpec spec) {
+    SpriteInstance instance = {position, scale, spec, color};
+    render(sampler, std::span<const SpriteInstance>(&instance, 1));
+}
+
+void SpritesheetRender::render(GLint sampler, std::span<const SpriteInstance> instances) {
+    if (instances.empty()) {
+        return;
+    }
+    glState().useProgram(shared->program);
     glUniform1i(uniformSampler, sampler);
-    glUniform2f(uniformMin, spec.min.x, spec.min.y);
-    glUniform2f(uniformMax, spec.max.x, spec.max.y);
-    glBindVertexArray(shared->vao);
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+    StreamAllocation stream = frameStream().write(instances);
+    glState().bindVertexArray(shared->vao);
+    glBindBuffer(GL_ARRAY_BUFFER, stream.buffer);
+    const char* base = (const char*) stream.offset;
+    glVertexAttribPointer(ATTRIB_INSTANCE_OFFSET, 2, GL_FLOAT, false, sizeof(SpriteInstance), base + offsetof(SpriteInstance, offset));
+    glVertexAttribPointer(ATTRIB_INSTANCE_SCALE, 2, GL_FLOAT, false, sizeof(SpriteInstance), base + offsetof(SpriteInstance, scale));
+    glVertexAttribPointer(ATTRIB_INSTANCE_FRAME, 4, GL_FLOAT, false, sizeof(SpriteInstance), base + offsetof(SpriteInstance, spec));
+    glVertexAttribPointer(ATTRIB_INSTANCE_COLOR, 4, GL_FLOAT, false, sizeof(SpriteInstance), base + offsetof(SpriteInstance, color));
+    glDrawArraysInstanced(GL_TRIANGLES, 0, 6, (GLsizei) instances.size());
 }
 
 SpritesheetRender::Shared::~Shared() {
-    glDeleteProgram(program);
+    untrackBuffer(vbo);
     glDeleteBuffers(1, &vbo);
+    glState().forgetVertexArray(vao);
     glDeleteVertexArrays(1, &vao);
 }
 
@@ -3,6 +3,7 @@
 #include "graphics.h"
 #include <map>
 #include <memory>
+#include <span>
 
 struct SpritesheetSpec {
     glm::vec2 min;
@@ -10,11 +11,28 @@ struct SpritesheetSpec {
 };
 
 SpritesheetSpec textureGrid(int sheetWidth, int sheetHeight, int index);
+// the same frame lookup inside a sub-rect, e.g. a sprite sheet packed into an atlas
+SpritesheetSpec textureGrid(const SpritesheetSpec& region, int sheetWidth, int sheetHeight, int index);
+
+// one sprite of an instanced draw, a negative scale flips it
+struct SpriteInstance {
+    glm::vec2 offset;
+    glm::vec2 scale;
+    SpritesheetSpec spec;
+    glm::vec4 color;
+};
 
 class SpritesheetRender {
 public:
     SpritesheetRender();
-    void render(glm::mat4 matrix, glm::vec4 color, GLint sampler, SpritesheetSpec spec);
+    // single sprite centered on position
+    void render(glm::vec2 position, glm::vec2 scale, glm::vec4 color, GLint sampler, SpritesheetSpec spec);
+    // every instance in one draw call, the view projection comes from setFrameUniforms()
+    void render(GLint sampler, std::span<const SpriteInstance> instances);
+    // for render queue sort keys
+    inline GLuint program() const {
+        return (GLuint) shared->program;
+    }
 private:
     // Shared is used so that Renders can be copied and still work just fine
     struct Shared {
@@ -24,10 +42,6 @@ private:
         ~Shared();
     };
     std::shared_ptr<Shared> shared;
-    GLint uniformMatrix;
-    GLint uniformMin;
-    GLint uniformMax;
-    GLint uniformColor;
     GLint uniformSampler;
 };
 
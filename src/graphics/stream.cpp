@@ -0,0 +1,209 @@
+#include "stream.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <memory>
+
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+const size_t FRAME_STREAM_SEGMENT_BYTES = 2 << 20;
+// one segment being written, up to two still being drawn
+const int FRAME_STREAM_SEGMENTS = 3;
+
+typedef void (APIENTRYP PFNBUFFERSTORAGEPROC)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+static PFNBUFFERSTORAGEPROC bufferStorage = nullptr;
+
+static std::unique_ptr<StreamBuffer> stream;
+
+static void deleteBuffer(GLuint buffer, bool mapped) {
+    if (mapped) {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+    }
+    untrackBuffer(buffer);
+    glDeleteBuffers(1, &buffer);
+}
+
+static bool hasExtension(std::string_view name) {
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; ++i) {
+        const GLubyte* extension = glGetStringi(GL_EXTENSIONS, i);
+        if (extension && name == (const char*) extension) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void loadBufferStorage(GLADloadproc load) {
+    bool core = GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 4);
+    if (core || hasExtension("GL_ARB_buffer_storage")) {
+        bufferStorage = (PFNBUFFERSTORAGEPROC) load("glBufferStorage");
+    }
+}
+
+StreamBuffer& frameStream() {
+    if (!stream) {
+        MemoryScope scope(MEMORY_RENDER);
+        stream = std::make_unique<StreamBuffer>(FRAME_STREAM_SEGMENT_BYTES, FRAME_STREAM_SEGMENTS);
+    }
+    return *stream;
+}
+
+void releaseFrameStream() {
+    stream.reset();
+}
+
+StreamBuffer::StreamBuffer(size_t segmentBytes, int segmentCount) : segmentCount(segmentCount), fences(segmentCount, nullptr) {
+    allocate(segmentBytes);
+}
+
+StreamBuffer::~StreamBuffer() {
+    release();
+    for (const Retired& old : retired) {
+        if (old.fence) {
+            glDeleteSync(old.fence);
+        }
+        deleteBuffer(old.buffer, old.mapped);
+    }
+}
+
+void StreamBuffer::allocate(size_t segmentBytes) {
+    this->segmentBytes = segmentBytes;
+    size_t total = segmentBytes * segmentCount;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    if (bufferStorage) {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        bufferStorage(GL_COPY_WRITE_BUFFER, total, nullptr, flags);
+        mapped = (GLubyte*) glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, total, flags);
+    }
+    if (!mapped) {
+        glBufferData(GL_COPY_WRITE_BUFFER, total, nullptr, GL_STREAM_DRAW);
+    }
+    trackBuffer(buffer, total);
+    segment = 0;
+    offset = 0;
+    segmentReady = false;
+}
+
+void StreamBuffer::release() {
+    for (GLsync& fence : fences) {
+        if (fence) {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+    deleteBuffer(buffer, mapped != nullptr);
+    mapped = nullptr;
+    buffer = 0;
+}
+
+// the GL commands for this frame come after the ones for earlier frames, so the fence endFrame() makes
+// for the retired buffer also covers the segments the old fences were waiting on
+void StreamBuffer::retire() {
+    for (GLsync& fence : fences) {
+        if (fence) {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+    retired.push_back({buffer, mapped != nullptr, nullptr});
+    mapped = nullptr;
+    buffer = 0;
+}
+
+void StreamBuffer::waitForSegment(int index) {
+    GLsync& fence = fences[index];
+    if (!fence) {
+        return;
+    }
+    if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+        auto start = std::chrono::steady_clock::now();
+        while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED) {
+        }
+        ++frameStats.stalls;
+        frameStats.stallMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+StreamAllocation StreamBuffer::write(const void* data, size_t bytes, size_t alignment) {
+    frameStats.bytes += bytes;
+    size_t start = (offset + alignment - 1) / alignment * alignment;
+    if (mapped) {
+        if (!segmentReady) {
+            waitForSegment(segment);
+            segmentReady = true;
+        }
+        if (start + bytes > segmentBytes) {
+            // a frame that needs more than a segment gets a bigger ring,
+            // everything already written this frame stays alive in the retired storage until drawn
+            retire();
+            allocate(std::max(segmentBytes * 2, bytes * 2));
+            ++frameStats.reallocations;
+            segmentReady = true;
+            start = 0;
+        }
+        size_t position = segment * segmentBytes + start;
+        std::memcpy(mapped + position, data, bytes);
+        offset = start + bytes;
+        return {buffer, position};
+    }
+
+    // no persistent mapping, the whole buffer is one ring, orphaned by endFrame()
+    // re-specifying it here would pull the storage out from under this frame's earlier writes
+    if (start + bytes > segmentBytes * segmentCount) {
+        retire();
+        allocate(std::max(segmentBytes * 2, bytes * 2));
+        ++frameStats.reallocations;
+        start = 0;
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, start, bytes, data);
+    offset = start + bytes;
+    return {buffer, start};
+}
+
+void StreamBuffer::endFrame() {
+    for (size_t i = 0; i < retired.size();) {
+        Retired& old = retired[i];
+        if (!old.fence) {
+            old.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            ++i;
+        } else if (glClientWaitSync(old.fence, 0, 0) != GL_TIMEOUT_EXPIRED) {
+            glDeleteSync(old.fence);
+            deleteBuffer(old.buffer, old.mapped);
+            retired.erase(retired.begin() + i);
+        } else {
+            ++i;
+        }
+    }
+    if (!mapped) {
+        // orphaned while no allocation points into it, once the next frame might not fit
+        if (offset + segmentBytes > segmentBytes * segmentCount) {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+            glBufferData(GL_COPY_WRITE_BUFFER, segmentBytes * segmentCount, nullptr, GL_STREAM_DRAW);
+            ++frameStats.reallocations;
+            offset = 0;
+        }
+        lastStats = frameStats;
+        frameStats = StreamStats();
+        return;
+    }
+    lastStats = frameStats;
+    frameStats = StreamStats();
+    if (segmentReady) {
+        fences[segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        segment = (segment + 1) % segmentCount;
+        offset = 0;
+        segmentReady = false;
+    }
+}
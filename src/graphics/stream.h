@@ -0,0 +1,84 @@
+#ifndef _GRAPHICS_STREAM_H
+#define _GRAPHICS_STREAM_H
+#include "graphics.h"
+#include <span>
+#include <vector>
+
+struct StreamStats {
+    size_t bytes = 0;
+    // writes that had to wait for the GPU to finish with a segment
+    int stalls = 0;
+    double stallMs = 0.0;
+    // times the storage was orphaned or reallocated
+    int reallocations = 0;
+};
+
+// where a write went, valid until the end of the frame
+struct StreamAllocation {
+    GLuint buffer;
+    size_t offset;
+};
+
+// a ring of per frame segments that all dynamic geometry is written into
+// with glBufferStorage the whole ring is mapped once, persistently, and a fence per segment
+// keeps the CPU from overwriting data the GPU hasn't drawn yet
+// without it the buffer is filled with glBufferSubData and orphaned between frames when it is nearly full
+// a frame that outgrows the storage moves to a new, bigger buffer, the old one is kept until the GPU is done with it
+class StreamBuffer {
+public:
+    StreamBuffer(size_t segmentBytes, int segmentCount);
+    ~StreamBuffer();
+    StreamBuffer(const StreamBuffer&) = delete;
+    StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+    StreamAllocation write(const void* data, size_t bytes, size_t alignment = 16);
+    template <typename T>
+    inline StreamAllocation write(std::span<const T> data) {
+        return write(data.data(), data.size_bytes(), alignof(T) > 16 ? alignof(T) : 16);
+    }
+    // call once per frame after the last draw using this frame's writes
+    void endFrame();
+    inline bool persistent() const {
+        return mapped != nullptr;
+    }
+    // the last finished frame
+    inline const StreamStats& stats() const {
+        return lastStats;
+    }
+private:
+    // storage that writes from this frame or an earlier one may still be drawn from
+    struct Retired {
+        GLuint buffer;
+        bool mapped;
+        // made at the end of the frame that retired it
+        GLsync fence;
+    };
+    void allocate(size_t segmentBytes);
+    void release();
+    // swaps the buffer out for later writes without invalidating the allocations already handed out
+    void retire();
+    void waitForSegment(int index);
+
+    GLuint buffer = 0;
+    GLubyte* mapped = nullptr;
+    size_t segmentBytes;
+    int segmentCount;
+    int segment = 0;
+    size_t offset = 0;
+    bool segmentReady = false;
+    std::vector<GLsync> fences;
+    std::vector<Retired> retired;
+    StreamStats frameStats;
+    StreamStats lastStats;
+};
+
+// looks up glBufferStorage, which the GL 4.3 loader doesn't have
+// call after gladLoadGLLoader, without it streaming falls back to orphaning
+void loadBufferStorage(GLADloadproc load);
+
+// the stream every renderer writes its per frame data into, made on first use
+StreamBuffer& frameStream();
+// call while the context is still current
+void releaseFrameStream();
+
+#endif
@@ -0,0 +1,211 @@
+#include "text.h"
+#include "spritebatch.h"
+#include "glstate.h"
+#include <algorithm>
+#include <cmath>
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+// between glyphs in the atlas, so linear filtering never picks up a neighbour
+const int GLYPH_PADDING = 1;
+// decoded in place of bytes that aren't valid UTF-8
+const uint32_t REPLACEMENT_CODEPOINT = '?';
+
+Font::Font(const std::string& file, int pixelSize, int atlasSize) {
+    shared = std::shared_ptr<Shared>(new Shared());
+    FT_Library library;
+    if (FT_Init_FreeType(&library)) {
+        throw std::runtime_error("Failed to initialize FreeType");
+    }
+    shared->library = library;
+    FT_Face face;
+    if (FT_New_Face(library, file.c_str(), 0, &face)) {
+        throw std::runtime_error("Failed to load font " + file);
+    }
+    shared->face = face;
+    FT_Set_Pixel_Sizes(face, 0, pixelSize);
+    shared->lineHeight = (int) (face->size->metrics.height >> 6);
+    shared->ascender = (int) (face->size->metrics.ascender >> 6);
+    shared->atlasSize = atlasSize;
+
+    // starts empty apart from the solid texel in the corner
+    std::vector<GLubyte> pixels((size_t) atlasSize * atlasSize * 4, 0);
+    for (int y = 0; y < 2; ++y) {
+        for (int x = 0; x < 2; ++x) {
+            std::fill_n(pixels.begin() + ((size_t) y * atlasSize + x) * 4, 4, 255);
+        }
+    }
+    shared->penX = 2 + GLYPH_PADDING;
+    shared->penY = 0;
+    glGenTextures(1, &shared->texture);
+    glState().bindTexture(0, GL_TEXTURE_2D, shared->texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, atlasSize, atlasSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    trackTexture(shared->texture, pixels.size());
+
+    // printable ASCII is what the HUD draws, rasterizing it now keeps uploads out of the first frames
+    for (uint32_t c = ' '; c < 127; ++c) {
+        glyph(c);
+    }
+    upload();
+}
+
+const Glyph& Font::glyph(uint32_t codepoint) {
+    if (codepoint < 128) {
+        if (!shared->asciiLoaded[codepoint]) {
+            shared->ascii[codepoint] = rasterize(codepoint);
+            shared->asciiLoaded[codepoint] = true;
+        }
+        return shared->ascii[codepoint];
+    }
+    auto found = shared->glyphs.find(codepoint);
+    if (found != shared->glyphs.end()) {
+        return found->second;
+    }
+    return shared->glyphs.insert({codepoint, rasterize(codepoint)}).first->second;
+}
+
+Glyph Font::rasterize(uint32_t codepoint) {
+    FT_Face face = (FT_Face) shared->face;
+    if (FT_Load_Char(face, codepoint, FT_LOAD_RENDER)) {
+        return codepoint == REPLACEMENT_CODEPOINT ? Glyph() : this->glyph(REPLACEMENT_CODEPOINT);
+    }
+    const FT_Bitmap& bitmap = face->glyph->bitmap;
+    Glyph glyph;
+    glyph.width = (int) bitmap.width;
+    glyph.height = (int) bitmap.rows;
+    glyph.bearingX = face->glyph->bitmap_left;
+    glyph.bearingY = face->glyph->bitmap_top;
+    glyph.advance = (int) (face->glyph->advance.x >> 6);
+    if (glyph.width == 0 || glyph.height == 0) {
+        return glyph;
+    }
+    if (shared->penX + glyph.width > shared->atlasSize) {
+        shared->penX = 0;
+        shared->penY += shared->shelfHeight + GLYPH_PADDING;
+        shared->shelfHeight = 0;
+    }
+    if (shared->penY + glyph.height > shared->atlasSize) {
+        ++shared->stats.dropped;
+        return codepoint == REPLACEMENT_CODEPOINT ? Glyph() : this->glyph(REPLACEMENT_CODEPOINT);
+    }
+    glyph.x = shared->penX;
+    glyph.y = shared->penY;
+    shared->penX += glyph.width + GLYPH_PADDING;
+    shared->shelfHeight = std::max(shared->shelfHeight, glyph.height);
+
+    std::vector<GLubyte> pixels((size_t) glyph.width * glyph.height * 4);
+    for (int y = 0; y < glyph.height; ++y) {
+        const unsigned char* row = bitmap.buffer + (ptrdiff_t) y * bitmap.pitch;
+        for (int x = 0; x < glyph.width; ++x) {
+            GLubyte* texel = &pixels[((size_t) y * glyph.width + x) * 4];
+            texel[0] = texel[1] = texel[2] = 255;
+            texel[3] = row[x];
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(shared->pendingMutex);
+        shared->pending.push_back({glyph, std::move(pixels)});
+    }
+    ++shared->stats.glyphs;
+    return glyph;
+}
+
+void Font::upload() {
+    std::vector<PendingGlyph> pending;
+    {
+        std::lock_guard<std::mutex> lock(shared->pendingMutex);
+        if (shared->pending.empty()) {
+            return;
+        }
+        pending.swap(shared->pending);
+    }
+    glState().bindTexture(0, GL_TEXTURE_2D, shared->texture);
+    for (const PendingGlyph& p : pending) {
+        const Glyph& glyph = p.glyph;
+        glTexSubImage2D(GL_TEXTURE_2D, 0, glyph.x, glyph.y, glyph.width, glyph.height, GL_RGBA, GL_UNSIGNED_BYTE, p.pixels.data());
+    }
+}
+
+Font::Shared::~Shared() {
+    if (texture) {
+        untrackTexture(texture);
+        glState().forgetTexture(texture);
+        glDeleteTextures(1, &texture);
+    }
+    if (face) {
+        FT_Done_Face((FT_Face) face);
+    }
+    if (library) {
+        FT_Done_FreeType((FT_Library) library);
+    }
+}
+
+// one codepoint from the front of text, malformed sequences come out as one replacement each
+static uint32_t nextCodepoint(std::string_view text, size_t& i) {
+    unsigned char lead = (unsigned char) text[i++];
+    if (lead < 0x80) {
+        return lead;
+    }
+    int length = lead >= 0xF0 ? 3 : lead >= 0xE0 ? 2 : lead >= 0xC0 ? 1 : -1;
+    if (length < 0) {
+        return REPLACEMENT_CODEPOINT;
+    }
+    uint32_t codepoint = lead & (0x3F >> length);
+    for (int k = 0; k < length; ++k) {
+        if (i >= text.size() || ((unsigned char) text[i] & 0xC0) != 0x80) {
+            return REPLACEMENT_CODEPOINT;
+        }
+        codepoint = (codepoint << 6) | ((unsigned char) text[i++] & 0x3F);
+    }
+    return codepoint;
+}
+
+// calls place(glyph, corner) for every glyph with pixels, corner is its top left
+template <typename F>
+static glm::vec2 layoutText(Font& font, std::string_view text, glm::vec2 position, F place) {
+    float penX = position.x, baseline = position.y + font.ascender();
+    float width = 0.0f;
+    int lines = text.empty() ? 0 : 1;
+    for (size_t i = 0; i < text.size();) {
+        uint32_t codepoint = nextCodepoint(text, i);
+        if (codepoint == '\n') {
+            width = std::max(width, penX - position.x);
+            penX = position.x;
+            baseline += font.lineHeight();
+            ++lines;
+            continue;
+        }
+        const Glyph& glyph = font.glyph(codepoint);
+        if (glyph.width > 0) {
+            place(glyph, glm::vec2(penX + glyph.bearingX, baseline - glyph.bearingY));
+        }
+        penX += glyph.advance;
+    }
+    width = std::max(width, penX - position.x);
+    return {width, (float) (lines * font.lineHeight())};
+}
+
+glm::vec2 drawText(SpriteBatch& batch, int layer, Font& font, std::string_view text, glm::vec2 position, glm::vec4 color) {
+    // whole pixels keep glyphs sampled 1:1
+    position = glm::vec2(std::floor(position.x), std::floor(position.y));
+    float texel = 1.0f / font.atlasSize();
+    GLuint texture = font.texture();
+    return layoutText(font, text, position, [&](const Glyph& glyph, glm::vec2 corner) {
+        glm::vec2 size = {(float) glyph.width, (float) glyph.height};
+        SpritesheetSpec spec = {glm::vec2(glyph.x, glyph.y) * texel, glm::vec2(glyph.x + glyph.width, glyph.y + glyph.height) * texel};
+        batch.draw(layer, texture, corner + size * 0.5f, size, spec, color);
+    });
+}
+
+glm::vec2 measureText(Font& font, std::string_view text) {
+    return layoutText(font, text, glm::vec2(0.0f), [](const Glyph& glyph, glm::vec2 corner) {});
+}
+
+void drawRect(SpriteBatch& batch, int layer, const Font& font, glm::vec2 min, glm::vec2 max, glm::vec4 color) {
+    batch.draw(layer, font.texture(), (min + max) * 0.5f, max - min, font.solid(), color);
+}
@@ -0,0 +1,92 @@
+#ifndef _GRAPHICS_TEXT_H
+#define _GRAPHICS_TEXT_H
+#include "graphics.h"
+#include "spritesheet.h"
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+class SpriteBatch;
+
+// where a glyph is in the font's atlas and how it sits on the baseline, all in pixels
+struct Glyph {
+    int x = 0, y = 0;
+    int width = 0, height = 0;
+    int bearingX = 0, bearingY = 0;
+    int advance = 0;
+};
+
+struct FontStats {
+    int glyphs = 0;
+    // glyphs that didn't fit in the atlas and are drawn as '?'
+    int dropped = 0;
+};
+
+// a FreeType face at one pixel size, glyphs are rasterized into an atlas texture the first time they are drawn
+// the atlas is white with coverage in alpha, so text goes through SpriteBatch like any sprite
+// and a whole screen of text is one draw call
+// new glyphs wait in memory until upload(), so text can be laid out on a thread without the GL context
+class Font {
+public:
+    Font(const std::string& file, int pixelSize, int atlasSize = 512);
+    const Glyph& glyph(uint32_t codepoint);
+    // copies glyphs rasterized since the last upload into the texture, call before drawing text
+    void upload();
+    inline GLuint texture() const {
+        return shared->texture;
+    }
+    inline int lineHeight() const {
+        return shared->lineHeight;
+    }
+    inline int ascender() const {
+        return shared->ascender;
+    }
+    inline int atlasSize() const {
+        return shared->atlasSize;
+    }
+    // a fully covered texel, for solid rectangles drawn in the same batch as the text
+    inline SpritesheetSpec solid() const {
+        float texel = 0.5f / shared->atlasSize;
+        return {{texel, texel}, {texel, texel}};
+    }
+    inline const FontStats& stats() const {
+        return shared->stats;
+    }
+private:
+    Glyph rasterize(uint32_t codepoint);
+
+    struct PendingGlyph {
+        Glyph glyph;
+        std::vector<GLubyte> pixels;
+    };
+    // Shared is used so that fonts can be copied and still work just fine
+    struct Shared {
+        void* library = nullptr;
+        void* face = nullptr;
+        GLuint texture = 0;
+        int atlasSize;
+        int lineHeight;
+        int ascender;
+        // shelf packing, glyphs are placed left to right in rows as tall as their tallest glyph
+        int penX, penY, shelfHeight = 0;
+        Glyph ascii[128];
+        bool asciiLoaded[128] = {};
+        std::unordered_map<uint32_t, Glyph> glyphs;
+        std::mutex pendingMutex;
+        std::vector<PendingGlyph> pending;
+        FontStats stats;
+        ~Shared();
+    };
+    std::shared_ptr<Shared> shared;
+};
+
+// lays UTF-8 text out into the batch with its first line's top left corner at position, in pixels
+// '\n' starts a new line, returns the size of the text
+glm::vec2 drawText(SpriteBatch& batch, int layer, Font& font, std::string_view text, glm::vec2 position, glm::vec4 color);
+glm::vec2 measureText(Font& font, std::string_view text);
+// a solid rectangle from the font's atlas, so it batches with text
+void drawRect(SpriteBatch& batch, int layer, const Font& font, glm::vec2 min, glm::vec2 max, glm::vec4 color);
+
+#endif
@@ -0,0 +1,207 @@
+#include "texturefile.h"
+#include "glstate.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const uint32_t TEXTURE_FILE_MAGIC = 0x42584554; // "TEXB"
+const uint32_t TEXTURE_FILE_VERSION = 1;
+// level data starts on this boundary so it can be handed to GL as is
+const size_t TEXTURE_FILE_ALIGNMENT = 16;
+
+struct TextureFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint32_t format;
+    uint32_t images;
+    uint32_t levels;
+    uint32_t metadataBytes;
+};
+
+static size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+TextureFile::~TextureFile() {
+    if (mapping != nullptr) {
+        munmap((void*) mapping, mappedBytes);
+    }
+}
+
+bool TextureFile::open(const std::string& path, uint64_t key) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    void* mapped = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && (size_t) info.st_size >= sizeof(TextureFileHeader)) {
+        mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    // the mapping stays valid after the descriptor is closed
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        return false;
+    }
+    const GLubyte* bytes = (const GLubyte*) mapped;
+    size_t size = info.st_size;
+    const TextureFileHeader& header = *(const TextureFileHeader*) bytes;
+    size_t tableEnd = sizeof(TextureFileHeader) + (size_t) header.levels * sizeof(TextureFileLevel);
+    bool valid = header.magic == TEXTURE_FILE_MAGIC && header.version == TEXTURE_FILE_VERSION && header.key == key
+        && tableEnd + header.metadataBytes <= size;
+    std::span<const TextureFileLevel> levels;
+    if (valid) {
+        levels = {(const TextureFileLevel*) (bytes + sizeof(TextureFileHeader)), header.levels};
+        for (const TextureFileLevel& level : levels) {
+            valid = valid && level.image < header.images && level.offset <= size && level.bytes <= size - level.offset;
+        }
+    }
+    if (!valid) {
+        munmap(mapped, size);
+        return false;
+    }
+    if (mapping != nullptr) {
+        munmap((void*) mapping, mappedBytes);
+    }
+    mapping = bytes;
+    mappedBytes = size;
+    storedFormat = header.format;
+    images = (int) header.images;
+    table = levels;
+    meta = {bytes + tableEnd, header.metadataBytes};
+    return true;
+}
+
+int TextureFile::levelCount(int image) const {
+    return (int) std::count_if(table.begin(), table.end(), [image](const TextureFileLevel& level) {
+        return level.image == (uint32_t) image;
+    });
+}
+
+const TextureFileLevel& TextureFile::level(int image, int level) const {
+    for (const TextureFileLevel& entry : table) {
+        if (entry.image == (uint32_t) image && entry.level == (uint32_t) level) {
+            return entry;
+        }
+    }
+    throw std::runtime_error("Texture file has no level " + std::to_string(level) + " for image " + std::to_string(image));
+}
+
+std::span<const GLubyte> TextureFile::data(const TextureFileLevel& level) const {
+    return {mapping + level.offset, (size_t) level.bytes};
+}
+
+std::span<const GLubyte> TextureFile::metadata() const {
+    return meta;
+}
+
+bool filterUsesMipmaps(GLenum minFilter) {
+    return minFilter != GL_NEAREST && minFilter != GL_LINEAR;
+}
+
+GLuint TextureFile::upload(int image, GLenum minFilter, GLenum magFilter) const {
+    int levels = levelCount(image);
+    GLuint tex;
+    glGenTextures(1, &tex);
+    glState().bindTexture(0, GL_TEXTURE_2D, tex);
+    size_t trackedBytes = 0;
+    for (int i = 0; i < levels; ++i) {
+        const TextureFileLevel& entry = level(image, i);
+        std::span<const GLubyte> pixels = data(entry);
+        if (storedFormat == GL_RGBA8) {
+            glTexImage2D(GL_TEXTURE_2D, i, GL_RGBA8, entry.width, entry.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+        } else {
+            // anything else is a block compressed format the driver takes as is
+            glCompressedTexImage2D(GL_TEXTURE_2D, i, storedFormat, entry.width, entry.height, 0, (GLsizei) pixels.size(), pixels.data());
+        }
+        trackedBytes += pixels.size();
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, magFilter);
+    if (levels == 1 && filterUsesMipmaps(minFilter)) {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 1000);
+        glGenerateMipmap(GL_TEXTURE_2D);
+        // the mip chain adds about a third
+        trackedBytes = trackedBytes * 4 / 3;
+    }
+    trackTexture(tex, trackedBytes);
+    return tex;
+}
+
+// each texel of the next level is the average of the 2x2 block above it
+static std::vector<GLubyte> halveImage(std::span<const GLubyte> pixels, int width, int height, int& halfWidth, int& halfHeight) {
+    halfWidth = std::max(1, width / 2);
+    halfHeight = std::max(1, height / 2);
+    std::vector<GLubyte> half((size_t) halfWidth * halfHeight * 4);
+    for (int y = 0; y < halfHeight; ++y) {
+        for (int x = 0; x < halfWidth; ++x) {
+            int x0 = std::min(x * 2, width - 1), x1 = std::min(x * 2 + 1, width - 1);
+            int y0 = std::min(y * 2, height - 1), y1 = std::min(y * 2 + 1, height - 1);
+            for (int c = 0; c < 4; ++c) {
+                int sum = pixels[((size_t) y0 * width + x0) * 4 + c] + pixels[((size_t) y0 * width + x1) * 4 + c]
+                    + pixels[((size_t) y1 * width + x0) * 4 + c] + pixels[((size_t) y1 * width + x1) * 4 + c];
+                half[((size_t) y * halfWidth + x) * 4 + c] = (GLubyte) ((sum + 2) / 4);
+            }
+        }
+    }
+    return half;
+}
+
+bool bakeTextureFile(const std::string& path, uint64_t key, std::span<const TextureBakeImage> images, bool mipmaps,
+        std::span<const GLubyte> metadata) {
+    MemoryScope scope(MEMORY_ASSETS);
+    // every level's pixels, in table order
+    std::vector<TextureFileLevel> table;
+    std::vector<std::vector<GLubyte>> mips;
+    std::vector<std::span<const GLubyte>> levelData;
+    for (size_t i = 0; i < images.size(); ++i) {
+        const TextureBakeImage& image = images[i];
+        int width = image.width, height = image.height;
+        std::span<const GLubyte> pixels = image.pixels;
+        for (uint32_t level = 0; ; ++level) {
+            table.push_back({(uint32_t) i, level, (uint32_t) width, (uint32_t) height, 0, pixels.size()});
+            levelData.push_back(pixels);
+            if (!mipmaps || (width == 1 && height == 1)) {
+                break;
+            }
+            mips.push_back(halveImage(pixels, width, height, width, height));
+            pixels = mips.back();
+        }
+    }
+    size_t offset = alignUp(sizeof(TextureFileHeader) + table.size() * sizeof(TextureFileLevel) + metadata.size(), TEXTURE_FILE_ALIGNMENT);
+    for (TextureFileLevel& level : table) {
+        level.offset = offset;
+        offset = alignUp(offset + level.bytes, TEXTURE_FILE_ALIGNMENT);
+    }
+
+    TextureFileHeader header = {TEXTURE_FILE_MAGIC, TEXTURE_FILE_VERSION, key, GL_RGBA8, (uint32_t) images.size(),
+        (uint32_t) table.size(), (uint32_t) metadata.size()};
+    std::error_code error;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), error);
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        file.write((const char*) &header, sizeof(header));
+        file.write((const char*) table.data(), table.size() * sizeof(TextureFileLevel));
+        file.write((const char*) metadata.data(), metadata.size());
+        for (size_t i = 0; i < table.size(); ++i) {
+            file.seekp(table[i].offset);
+            file.write((const char*) levelData[i].data(), levelData[i].size());
+        }
+        if (!file) {
+            std::filesystem::remove(temporary, error);
+            return false;
+        }
+    }
+    std::filesystem::rename(temporary, path, error);
+    return !error;
+}
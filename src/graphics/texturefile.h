@@ -0,0 +1,73 @@
+#ifndef _GRAPHICS_TEXTUREFILE_H
+#define _GRAPHICS_TEXTUREFILE_H
+#include "graphics.h"
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// baked textures live here, one file per set of sources
+const std::string TEXTURE_CACHE_DIRECTORY = "texturecache";
+
+// where one level of one image is in the file
+struct TextureFileLevel {
+    uint32_t image;
+    uint32_t level;
+    uint32_t width, height;
+    uint64_t offset;
+    uint64_t bytes;
+};
+
+// a baked texture container: header, level table, caller metadata, then the level data
+// it is memory mapped read only, so uploads read straight out of the page cache
+// with no decoding and no mip generation
+class TextureFile {
+public:
+    TextureFile() = default;
+    ~TextureFile();
+    TextureFile(const TextureFile&) = delete;
+    TextureFile& operator=(const TextureFile&) = delete;
+
+    // false when the file is missing, truncated, or was baked from other sources
+    bool open(const std::string& path, uint64_t key);
+    inline bool isOpen() const {
+        return mapping != nullptr;
+    }
+    inline GLenum format() const {
+        return storedFormat;
+    }
+    inline int imageCount() const {
+        return images;
+    }
+    int levelCount(int image) const;
+    const TextureFileLevel& level(int image, int level) const;
+    std::span<const GLubyte> data(const TextureFileLevel& level) const;
+    std::span<const GLubyte> metadata() const;
+    // makes a GL_TEXTURE_2D from the image's stored levels
+    // mips are only generated here if the filter needs them and none were baked
+    GLuint upload(int image, GLenum minFilter, GLenum magFilter) const;
+private:
+    const GLubyte* mapping = nullptr;
+    size_t mappedBytes = 0;
+    GLenum storedFormat = 0;
+    int images = 0;
+    // every level of every image, by image then level
+    std::span<const TextureFileLevel> table;
+    std::span<const GLubyte> meta;
+};
+
+struct TextureBakeImage {
+    int width, height;
+    // RGBA8, width * height * 4 bytes
+    std::span<const GLubyte> pixels;
+};
+
+bool filterUsesMipmaps(GLenum minFilter);
+
+// writes RGBA8 images to a texture file, with a box filtered mip chain for each when mipmaps is set
+// the file is written next to path and renamed into place, so readers never see half of it
+// returns false if it couldn't be written, which only costs a rebake next time
+bool bakeTextureFile(const std::string& path, uint64_t key, std::span<const TextureBakeImage> images, bool mipmaps,
+    std::span<const GLubyte> metadata = {});
+
+#endif
@@ -0,0 +1,141 @@
+#include "tilemap.h"
+#include "program.h"
+#include "glstate.h"
+#include <algorithm>
+
+const int TILEMAP_INITIAL_LAYERS = 16;
+// more changed cells than this in one update and the whole layer is uploaded instead
+const int TILEMAP_MAX_CELL_UPLOADS = 8;
+const int TILEMAP_CELLS_UNIT = 1;
+
+TileMapRender::TileMapRender(int chunkSize, int sheetTilesX, int sheetTilesY) : sheetTilesX(sheetTilesX), sheetTilesY(sheetTilesY) {
+    const ShaderProgram& program = loadProgram("res/texture_v.glsl", "res/tilemap_f.glsl");
+    uniformTransform = program.uniform("transform");
+    uniformColor = program.uniform("color");
+    uniformSampler = program.uniform("sampler");
+    uniformCells = program.uniform("cells");
+    uniformLayer = program.uniform("layer");
+    uniformChunkSize = program.uniform("chunkSize");
+    uniformSheetTiles = program.uniform("sheetTiles");
+    uniformSheetRegion = program.uniform("sheetRegion");
+
+    GLuint vao;
+    glGenVertexArrays(1, &vao);
+    glState().bindVertexArray(vao);
+
+    // the unit square, with texture coordinates across the whole chunk
+    GLfloat data[] = {
+        0.0f, 0.0f, 0.0f, 0.0f,
+        0.0f, 1.0f, 0.0f, 1.0f,
+        1.0f, 1.0f, 1.0f, 1.0f,
+        1.0f, 1.0f, 1.0f, 1.0f,
+        1.0f, 0.0f, 1.0f, 0.0f,
+        0.0f, 0.0f, 0.0f, 0.0f,
+    };
+    GLuint vbo;
+    glGenBuffers(1, &vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(data), data, GL_STATIC_DRAW);
+    trackBuffer(vbo, sizeof(data));
+
+    glEnableVertexAttribArray(ATTRIB_POSITION);
+    glVertexAttribPointer(ATTRIB_POSITION, 2, GL_FLOAT, false, 4 * sizeof(GLfloat), (void*) 0);
+    glEnableVertexAttribArray(ATTRIB_TEXTURE);
+    glVertexAttribPointer(ATTRIB_TEXTURE, 2, GL_FLOAT, false, 4 * sizeof(GLfloat), (void*) (2 * sizeof(GLfloat)));
+
+    GLuint cells;
+    glGenTextures(1, &cells);
+
+    shared = std::shared_ptr<Shared>(new Shared());
+    shared->program = program.id;
+    shared->vbo = vbo;
+    shared->vao = vao;
+    shared->cells = cells;
+    shared->chunkSize = chunkSize;
+}
+
+// reallocates the array texture with twice the layers and puts the old cells back from the mirror
+void TileMapRender::grow() {
+    int capacity = std::max(TILEMAP_INITIAL_LAYERS, shared->capacity * 2);
+    size_t layerSize = (size_t) shared->chunkSize * shared->chunkSize;
+    shared->mirror.resize(capacity * layerSize, 0);
+    shared->uploaded.resize(capacity, false);
+    for (int layer = capacity - 1; layer >= shared->capacity; --layer) {
+        shared->freeLayers.push_back(layer);
+    }
+    shared->capacity = capacity;
+
+    glState().bindTexture(TILEMAP_CELLS_UNIT, GL_TEXTURE_2D_ARRAY, shared->cells);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_R8UI, shared->chunkSize, shared->chunkSize, capacity, 0,
+        GL_RED_INTEGER, GL_UNSIGNED_BYTE, shared->mirror.data());
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, 0);
+    trackTexture(shared->cells, capacity * layerSize);
+}
+
+int TileMapRender::allocate() {
+    if (shared->freeLayers.empty()) {
+        grow();
+    }
+    int layer = shared->freeLayers.back();
+    shared->freeLayers.pop_back();
+    shared->uploaded[layer] = false;
+    return layer;
+}
+
+void TileMapRender::release(int layer) {
+    shared->freeLayers.push_back(layer);
+}
+
+void TileMapRender::update(int layer, std::span<const GLubyte> cells) {
+    int size = shared->chunkSize;
+    GLubyte* mirror = &shared->mirror[(size_t) layer * size * size];
+    int changed = 0;
+    for (int i = 0; i < size * size; ++i) {
+        changed += mirror[i] != cells[i];
+    }
+    if (changed == 0 && shared->uploaded[layer]) {
+        return;
+    }
+
+    glState().bindTexture(TILEMAP_CELLS_UNIT, GL_TEXTURE_2D_ARRAY, shared->cells);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    if (changed <= TILEMAP_MAX_CELL_UPLOADS && shared->uploaded[layer]) {
+        for (int i = 0; i < size * size; ++i) {
+            if (mirror[i] != cells[i]) {
+                glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, i % size, i / size, layer, 1, 1, 1, GL_RED_INTEGER, GL_UNSIGNED_BYTE, &cells[i]);
+            }
+        }
+    } else {
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, size, size, 1, GL_RED_INTEGER, GL_UNSIGNED_BYTE, cells.data());
+    }
+    std::copy(cells.begin(), cells.begin() + size * size, mirror);
+    shared->uploaded[layer] = true;
+}
+
+void TileMapRender::render(glm::vec2 position, float size, glm::vec4 color, GLint sampler, int layer, SpritesheetSpec sheet) const {
+    glState().useProgram(shared->program);
+    glUniform4f(uniformTransform, position.x, position.y, size, size);
+    glUniform4f(uniformColor, color.x, color.y, color.z, color.w);
+    glUniform1i(uniformSampler, sampler);
+    glUniform1i(uniformCells, TILEMAP_CELLS_UNIT);
+    glUniform1i(uniformLayer, layer);
+    glUniform1i(uniformChunkSize, shared->chunkSize);
+    glUniform2i(uniformSheetTiles, sheetTilesX, sheetTilesY);
+    glUniform4f(uniformSheetRegion, sheet.min.x, sheet.min.y, sheet.max.x, sheet.max.y);
+    glState().bindTexture(TILEMAP_CELLS_UNIT, GL_TEXTURE_2D_ARRAY, shared->cells);
+    glState().bindVertexArray(shared->vao);
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+}
+
+TileMapRender::Shared::~Shared() {
+    untrackBuffer(vbo);
+    untrackTexture(cells);
+    glDeleteBuffers(1, &vbo);
+    glState().forgetTexture(cells);
+    glDeleteTextures(1, &cells);
+    glState().forgetVertexArray(vao);
+    glDeleteVertexArrays(1, &vao);
+}
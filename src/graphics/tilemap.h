@@ -0,0 +1,54 @@
+#ifndef _GRAPHICS_TILEMAP_H
+#define _GRAPHICS_TILEMAP_H
+#include "graphics.h"
+#include "spritesheet.h"
+#include <memory>
+#include <span>
+#include <vector>
+
+// draws chunks straight from their cells: every chunk is one layer of an R8UI array
+// texture, and a single quad per chunk looks its tiles up in the tile sheet
+// a changed cell costs a one byte upload, chunks have no vertex data at all
+class TileMapRender {
+public:
+    TileMapRender(int chunkSize, int sheetTilesX, int sheetTilesY);
+    // layers are reused after release
+    int allocate();
+    void release(int layer);
+    // uploads only the cells that differ from the last update of this layer
+    void update(int layer, std::span<const GLubyte> cells);
+    // position is the chunk's corner and size its width in world units, sheet is where the tile sheet is in the bound texture
+    void render(glm::vec2 position, float size, glm::vec4 color, GLint sampler, int layer, SpritesheetSpec sheet) const;
+    // for render queue sort keys
+    inline GLuint program() const {
+        return (GLuint) shared->program;
+    }
+private:
+    void grow();
+    // Shared is used so that Renders can be copied and still work just fine
+    struct Shared {
+        GLint program;
+        GLuint vbo;
+        GLuint vao;
+        GLuint cells;
+        int chunkSize;
+        int capacity = 0;
+        // what each layer holds on the GPU, used to find changed cells
+        std::vector<GLubyte> mirror;
+        std::vector<bool> uploaded;
+        std::vector<int> freeLayers;
+        ~Shared();
+    };
+    std::shared_ptr<Shared> shared;
+    GLint uniformTransform;
+    GLint uniformColor;
+    GLint uniformSampler;
+    GLint uniformCells;
+    GLint uniformLayer;
+    GLint uniformChunkSize;
+    GLint uniformSheetTiles;
+    GLint uniformSheetRegion;
+    int sheetTilesX, sheetTilesY;
+};
+
+#endif
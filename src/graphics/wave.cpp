@@ -1,64 +1,69 @@
 #include "wave.h"
-#include "graphics.h"
+#include "program.h"
+#include "glstate.h"
+#include "stream.h"
+#include <cmath>
+#include <cstddef>
+#include <vector>
 
-WaveRender::WaveRender() {
-    GLint vshader = readShader("res/texture_v.glsl");
-    GLint fshader = readShader("res/wave_f.glsl");
-    GLint program = glCreateProgram();
-    glAttachShader(program, vshader);
-    glAttachShader(program, fshader);
-    glBindAttribLocation(program, ATTRIB_POSITION, "position");
-    glBindAttribLocation(program, ATTRIB_TEXTURE, "texture");
-    glLinkProgram(program);
-    checkProgram(program);
-    uniformMatrix = glGetUniformLocation(program, "matrix");
-    uniformColor = glGetUniformLocation(program, "color");
-    uniformRadius = glGetUniformLocation(program, "radius");
-    uniformThickness = glGetUniformLocation(program, "thickness");
+// sides of the polygon standing in for each circle
+const int WAVE_SEGMENTS = 48;
 
-    glDeleteShader(vshader);
-    glDeleteShader(fshader);
+WaveRender::WaveRender() {
+    const ShaderProgram& program = loadProgram("res/wave_v.glsl", "res/wave_f.glsl");
 
     GLuint vao;
     glGenVertexArrays(1, &vao);
-    glBindVertexArray(vao);
+    glState().bindVertexArray(vao);
 
-    GLfloat data[] = {
-        -0.5f, -0.5f, 0.0f, 0.0f,
-        -0.5f, +0.5f, 0.0f, 1.0f,
-        +0.5f, +0.5f, 1.0f, 1.0f,
-        +0.5f, +0.5f, 1.0f, 1.0f,
-        +0.5f, -0.5f, 1.0f, 0.0f,
-        -0.5f, -0.5f, 0.0f, 0.0f,
-    };
+    // a strip around the unit circle, alternating inner and outer edge
+    // xy is the direction from the center and z is -1 on the inner edge, +1 on the outer
+    std::vector<GLfloat> data;
+    for (int i = 0; i <= WAVE_SEGMENTS; ++i) {
+        float angle = 2.0f * 3.14159265f * (i % WAVE_SEGMENTS) / WAVE_SEGMENTS;
+        for (float side : {-1.0f, 1.0f}) {
+            data.insert(data.end(), {std::cos(angle), std::sin(angle), side});
+        }
+    }
     GLuint vbo;
     glGenBuffers(1, &vbo);
     glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(data), data, GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(GLfloat), data.data(), GL_STATIC_DRAW);
+    trackBuffer(vbo, data.size() * sizeof(GLfloat));
 
     glEnableVertexAttribArray(ATTRIB_POSITION);
-    glVertexAttribPointer(ATTRIB_POSITION, 2, GL_FLOAT, false, 4 * sizeof(GLfloat), (void*) 0);
-    glEnableVertexAttribArray(ATTRIB_TEXTURE);
-    glVertexAttribPointer(ATTRIB_TEXTURE, 2, GL_FLOAT, false, 4 * sizeof(GLfloat), (void*) (2 * sizeof(GLfloat)));
+    glVertexAttribPointer(ATTRIB_POSITION, 3, GL_FLOAT, false, 3 * sizeof(GLfloat), (void*) 0);
+
+    // per instance attributes, pointed at this draw's waves in frameStream()
+    for (GLint attrib : {ATTRIB_INSTANCE_OFFSET, ATTRIB_INSTANCE_SCALE, ATTRIB_INSTANCE_COLOR}) {
+        glEnableVertexAttribArray(attrib);
+        glVertexAttribDivisor(attrib, 1);
+    }
 
     shared = std::shared_ptr<Shared>(new Shared());
-    shared->program = program;
+    shared->program = program.id;
     shared->vbo = vbo;
     shared->vao = vao;
 }
 
-void WaveRender::render(glm::mat4 matrix, glm::vec4 color, float radius, float thickness) {
-    glUseProgram(shared->program);
-    glUniformMatrix4fv(uniformMatrix, 1, false, glm::value_ptr(matrix));
-    glUniform4f(uniformColor, color.x, color.y, color.z, color.w);
-    glUniform1f(uniformRadius, radius);
-    glUniform1f(uniformThickness, thickness);
-    glBindVertexArray(shared->vao);
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+void WaveRender::render(std::span<const WaveInstance> waves) {
+    if (waves.empty()) {
+        return;
+    }
+    glState().useProgram(shared->program);
+    StreamAllocation stream = frameStream().write(waves);
+    glState().bindVertexArray(shared->vao);
+    glBindBuffer(GL_ARRAY_BUFFER, stream.buffer);
+    const char* base = (const char*) stream.offset;
+    glVertexAttribPointer(ATTRIB_INSTANCE_OFFSET, 2, GL_FLOAT, false, sizeof(WaveInstance), base + offsetof(WaveInstance, center));
+    glVertexAttribPointer(ATTRIB_INSTANCE_SCALE, 2, GL_FLOAT, false, sizeof(WaveInstance), base + offsetof(WaveInstance, radius));
+    glVertexAttribPointer(ATTRIB_INSTANCE_COLOR, 4, GL_FLOAT, false, sizeof(WaveInstance), base + offsetof(WaveInstance, color));
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, (WAVE_SEGMENTS + 1) * 2, (GLsizei) waves.size());
 }
 
 WaveRender::Shared::~Shared() {
-    glDeleteProgram(program);
+    untrackBuffer(vbo);
     glDeleteBuffers(1, &vbo);
+    glState().forgetVertexArray(vao);
     glDeleteVertexArrays(1, &vao);
 }
@@ -1,13 +1,28 @@
 #ifndef _GRAPHICS_WAVE_H
 #define _GRAPHICS_WAVE_H
 #include "graphics.h"
-#include <map>
 #include <memory>
+#include <span>
 
+// one ring, in world units, faded out linearly over thickness on both sides of radius
+struct WaveInstance {
+    glm::vec2 center;
+    float radius;
+    float thickness;
+    glm::vec4 color;
+};
+
+// draws rings as instanced annulus strips that hug [radius - thickness, radius + thickness],
+// so only the ring itself is shaded instead of a quad around the whole circle
 class WaveRender {
 public:
     WaveRender();
-    void render(glm::mat4 matrix, glm::vec4 color, float radius, float thickness);
+    // every wave in one draw call, the view projection comes from setFrameUniforms()
+    void render(std::span<const WaveInstance> waves);
+    // for render queue sort keys
+    inline GLuint program() const {
+        return (GLuint) shared->program;
+    }
 private:
     // Shared is used so that Renders can be copied and still work just fine
     struct Shared {
@@ -17,10 +32,6 @@ private:
         ~Shared();
     };
     std::shared_ptr<Shared> shared;
-    GLint uniformMatrix;
-    GLint uniformColor;
-    GLint uniformRadius;
-    GLint uniformThickness;
 };
 
 #endif
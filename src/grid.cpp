@@ -1,9 +1,11 @@
 #include "grid.h"
 #include "util.h"
+#include "allocations.h"
 #include <glm/glm.hpp>
 #include <random>
 
 BlockType GridManager::set(BlockType type, int worldx, int worldy) {
+    MemoryScope scope(MEMORY_GRID);
     int gridx = divRoundDown(worldx, GRID_SIZE);
     int gridy = divRoundDown(worldy, GRID_SIZE);
     int ingridx = modRoundDown(worldx, GRID_SIZE);
@@ -20,6 +22,7 @@ BlockType GridManager::set(BlockType type, int worldx, int worldy) {
 }
 
 void GridManager::setGrid(Grid grid, int gridX, int gridY) {
+    MemoryScope scope(MEMORY_GRID);
     GridPos pos = {gridX, gridY};
     grids[pos] = grid;
     gridChanges.emit({pos, grid});
@@ -38,33 +41,28 @@ BlockType GridManager::check(int worldx, int worldy)const {
     return ptr->second.blocks[ingridy * GRID_SIZE + ingridx];
 }
 
-std::pair<glm::vec2, glm::vec2> getSpriteSheetCoordinates(int sheetTilesX, int sheetTilesY, int index) {
-    int x = modRoundDown(index, sheetTilesX);
-    int y = modRoundDown(divRoundDown(index, sheetTilesX), sheetTilesY);
-    float tileWidth = 1.0f / sheetTilesX, tileHeight = 1.0f / sheetTilesY;
-    float topLeftX = x * tileWidth, topLeftY = y * tileWidth;
-    return {{topLeftX, topLeftY}, {topLeftX + tileWidth, topLeftY + tileWidth}};
-}
-
-std::vector<float> makeTexturedBuffer(const Grid& grid) {
-    std::vector<float> buffer;
-    buffer.reserve(GRID_SIZE * GRID_SIZE * 6 * 4);
-    int sheetTilesX = TILE_SHEET_WIDTH, sheetTilesY = TILE_SHEET_HEIGHT;
+ScratchVector<ChunkVertex> makeChunkMesh(const Grid& grid) {
+    ScratchVector<ChunkVertex> mesh = scratchVector<ChunkVertex>();
+    mesh.reserve(GRID_SIZE * GRID_SIZE * 4);
     for (int y = 0; y < GRID_SIZE; ++y) {
         for (int x = 0; x < GRID_SIZE; ++x) {
             int index = grid.blocks[y * GRID_SIZE + x];
-            auto c = getSpriteSheetCoordinates(sheetTilesX, sheetTilesY, index);
-            buffer.insert(buffer.end(), {
-                (float) (x + 0) / GRID_SIZE, (float) (y + 0) / GRID_SIZE, c.first.x, c.first.y,
-                (float) (x + 0) / GRID_SIZE, (float) (y + 1) / GRID_SIZE, c.first.x, c.second.y,
-                (float) (x + 1) / GRID_SIZE, (float) (y + 1) / GRID_SIZE, c.second.x, c.second.y,
-                (float) (x + 1) / GRID_SIZE, (float) (y + 1) / GRID_SIZE, c.second.x, c.second.y,
-                (float) (x + 1) / GRID_SIZE, (float) (y + 0) / GRID_SIZE, c.second.x, c.first.y,
-                (float) (x + 0) / GRID_SIZE, (float) (y + 0) / GRID_SIZE, c.first.x, c.first.y,
+            if (index == air) {
+                continue;
+            }
+            // tiles are numbered row by row across the sheet
+            uint8_t u = (uint8_t) modRoundDown(index, TILE_SHEET_WIDTH);
+            uint8_t v = (uint8_t) modRoundDown(divRoundDown(index, TILE_SHEET_WIDTH), TILE_SHEET_HEIGHT);
+            uint8_t cx = (uint8_t) x, cy = (uint8_t) y;
+            mesh.insert(mesh.end(), {
+                {cx, cy, u, v},
+                {cx, (uint8_t) (cy + 1), u, (uint8_t) (v + 1)},
+                {(uint8_t) (cx + 1), (uint8_t) (cy + 1), (uint8_t) (u + 1), (uint8_t) (v + 1)},
+                {(uint8_t) (cx + 1), cy, (uint8_t) (u + 1), v},
             });
         }
     }
-    return buffer;
+    return mesh;
 }
 
 Grid randomGrid() {
@@ -80,13 +78,14 @@ Grid randomGrid() {
     return grid;
 }
 
-std::vector<GridPos> overlappingTiles(const Convex& convex) {
+ScratchVector<GridPos> overlappingTiles(const Convex& convex) {
     Box bounds = getBoundingBox(convex);
     int minX = floorInt(bounds.position.x - bounds.scale.x / 2.0f);
     int minY = floorInt(bounds.position.y - bounds.scale.y / 2.0f);
     int maxX = floorInt(bounds.position.x + bounds.scale.x / 2.0f) + 1;
     int maxY = floorInt(bounds.position.y + bounds.scale.y / 2.0f) + 1;
-    std::vector<GridPos> pos;
+    ScratchVector<GridPos> pos = scratchVector<GridPos>();
+    pos.reserve((maxY - minY + 1) * (maxX - minX + 1));
     for (int y = minY; y <= maxY; ++y) {
         for (int x = minX; x <= maxX; ++x) {
             pos.push_back({x, y});
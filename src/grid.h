@@ -2,6 +2,7 @@
 #define SRC_GRID_H_INCLUDED
 #include <map>
 #include <vector>
+#include <cstdint>
 #include <glm/glm.hpp>
 #include "events.h"
 #include "physics.h"
@@ -37,10 +38,18 @@ public:
     Event<std::pair<GridPos, Grid>> gridChanges;
 };
 
-std::vector<float> makeTexturedBuffer(const Grid& grid);
-std::pair<glm::vec2, glm::vec2> getSpriteSheetCoordinates(int sheetTilesX, int sheetTilesY, int index);
+// a chunk mesh vertex: position in cells from the chunk's corner, texture coordinate in tiles
+// from the tile sheet's corner, both exact so a byte each is enough
+struct ChunkVertex {
+    uint8_t x, y;
+    uint8_t u, v;
+};
+
+// four vertices per solid cell, drawn as indexed quads, air cells are left out
+ScratchVector<ChunkVertex> makeChunkMesh(const Grid& grid);
+
 Grid randomGrid();
-std::vector<GridPos> overlappingTiles(const Convex& convex);
+ScratchVector<GridPos> overlappingTiles(const Convex& convex);
 Box tileBox(int tileX, int tileY);
 
 #endif
@@ -0,0 +1,77 @@
+#include "hud.h"
+#include "graphics/spritebatch.h"
+#include <algorithm>
+#include <cstdio>
+
+const float HUD_MARGIN = 8.0f;
+const float HUD_GRAPH_HEIGHT = 60.0f;
+// the top of the graph, anything slower is clipped
+const float HUD_GRAPH_MAX_MS = 50.0f;
+const float HUD_60FPS_MS = 1000.0f / 60.0f;
+const float HUD_30FPS_MS = 1000.0f / 30.0f;
+const glm::vec4 HUD_BACKGROUND = {0.0f, 0.0f, 0.0f, 0.6f};
+const glm::vec4 HUD_TEXT = {1.0f, 1.0f, 1.0f, 1.0f};
+const glm::vec4 HUD_FAST = {0.3f, 0.9f, 0.3f, 1.0f};
+const glm::vec4 HUD_SLOW = {0.9f, 0.8f, 0.2f, 1.0f};
+const glm::vec4 HUD_TOO_SLOW = {0.9f, 0.2f, 0.2f, 1.0f};
+const glm::vec4 HUD_GUIDE = {1.0f, 1.0f, 1.0f, 0.3f};
+
+Hud::Hud(const Font& font) : font(font) {}
+
+void Hud::addFrame(double ms) {
+    frameMs[nextFrame] = (float) ms;
+    nextFrame = (nextFrame + 1) % HUD_GRAPH_FRAMES;
+    frames = std::min(frames + 1, HUD_GRAPH_FRAMES);
+}
+
+void Hud::draw(SpriteBatch& batch, int layer, const HudCounters& counters) {
+    float last = frameMs[(nextFrame + HUD_GRAPH_FRAMES - 1) % HUD_GRAPH_FRAMES];
+    float total = 0.0f, slowest = 0.0f;
+    for (int i = 0; i < frames; ++i) {
+        total += frameMs[i];
+        slowest = std::max(slowest, frameMs[i]);
+    }
+    float average = frames > 0 ? total / frames : 0.0f;
+
+    // a fixed buffer, the HUD shouldn't allocate every frame
+    char limit[16] = "off";
+    if (counters.pacingSettings.targetFps > 0.0) {
+        std::snprintf(limit, sizeof(limit), "%.0f fps", counters.pacingSettings.targetFps);
+    }
+    char text[640];
+    std::snprintf(text, sizeof(text),
+        "frame %5.2f ms  avg %5.2f  max %5.2f  %4.0f fps\n"
+        "ticks %d (%ld total)  bodies %d  objects %d\n"
+        "draw calls %d  commands %d  chunks %d\n"
+        "jitter %.2f ms  latency %.1f ms  waited %.2f ms\n"
+        "vsync %s  limit %s  queue %d\n"
+        "hud %.3f ms",
+        last, average, slowest, average > 0.0f ? 1000.0f / average : 0.0f,
+        counters.ticks, counters.totalTicks, counters.bodies, counters.objects,
+        counters.drawCalls, counters.commands, counters.chunks,
+        counters.pacing.deviationMs, counters.pacing.inputLatencyMs,
+        counters.pacing.sleepMs + counters.pacing.spinMs + counters.pacing.queueWaitMs,
+        counters.pacingSettings.vsync ? "on" : "off", limit, counters.pacingSettings.maxQueuedFrames, counters.hudMs);
+
+    glm::vec2 origin = {HUD_MARGIN, HUD_MARGIN};
+    glm::vec2 textSize = measureText(font, text);
+    float width = std::max(textSize.x, (float) HUD_GRAPH_FRAMES);
+    glm::vec2 graphBottomLeft = origin + glm::vec2(0.0f, textSize.y + HUD_MARGIN + HUD_GRAPH_HEIGHT);
+    drawRect(batch, layer, font, origin - HUD_MARGIN * 0.5f, glm::vec2(origin.x + width, graphBottomLeft.y) + HUD_MARGIN * 0.5f,
+        HUD_BACKGROUND);
+    drawText(batch, layer, font, text, origin, HUD_TEXT);
+
+    // oldest frame on the left
+    float pixelsPerMs = HUD_GRAPH_HEIGHT / HUD_GRAPH_MAX_MS;
+    for (int i = 0; i < frames; ++i) {
+        float ms = frameMs[(nextFrame + HUD_GRAPH_FRAMES - frames + i) % HUD_GRAPH_FRAMES];
+        float height = std::min(ms, HUD_GRAPH_MAX_MS) * pixelsPerMs;
+        const glm::vec4& color = ms <= HUD_60FPS_MS ? HUD_FAST : ms <= HUD_30FPS_MS ? HUD_SLOW : HUD_TOO_SLOW;
+        float x = graphBottomLeft.x + (HUD_GRAPH_FRAMES - frames + i);
+        drawRect(batch, layer, font, {x, graphBottomLeft.y - height}, {x + 1.0f, graphBottomLeft.y}, color);
+    }
+    for (float ms : {HUD_60FPS_MS, HUD_30FPS_MS}) {
+        float y = graphBottomLeft.y - ms * pixelsPerMs;
+        drawRect(batch, layer, font, {graphBottomLeft.x, y}, {graphBottomLeft.x + HUD_GRAPH_FRAMES, y + 1.0f}, HUD_GUIDE);
+    }
+}
@@ -0,0 +1,40 @@
+#ifndef SRC_HUD_H_INCLUDED
+#define SRC_HUD_H_INCLUDED
+#include "graphics/text.h"
+#include "pacing.h"
+#include <array>
+
+// frames in the frame time graph, one pixel wide each
+const int HUD_GRAPH_FRAMES = 240;
+
+// the engine's counters for the frame the HUD is drawn in
+struct HudCounters {
+    int ticks = 0;
+    long totalTicks = 0;
+    int drawCalls = 0;
+    int commands = 0;
+    int bodies = 0;
+    int objects = 0;
+    int chunks = 0;
+    // what drawing the HUD took last frame, building its quads and their draw
+    double hudMs = 0.0;
+    PacingStats pacing;
+    PacingSettings pacingSettings;
+};
+
+// performance overlay in the top left corner: frame time text, a rolling frame time graph and the counters
+// everything is quads from the font's atlas, so the whole HUD is one SpriteBatch draw
+class Hud {
+public:
+    explicit Hud(const Font& font);
+    void addFrame(double frameMs);
+    // screen pixels, the batch has to be drawn with a pixel projection
+    void draw(SpriteBatch& batch, int layer, const HudCounters& counters);
+private:
+    Font font;
+    std::array<float, HUD_GRAPH_FRAMES> frameMs = {};
+    int nextFrame = 0;
+    int frames = 0;
+};
+
+#endif
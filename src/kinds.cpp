@@ -0,0 +1,37 @@
+#include "kinds.h"
+#include "game.h"
+#include "graphics/spritebatch.h"
+
+static void updateNothing(GameObject* gameObject, double timeStep, World* world) {}
+
+// qualified calls so the behavior isn't dispatched virtually a second time
+static void updateEnemyClap(GameObject* gameObject, double timeStep, World* world) {
+    static_cast<EnemyClap*>(gameObject->behavior.get())->EnemyClap::update(timeStep, world);
+}
+
+static void updateEnemyShoot(GameObject* gameObject, double timeStep, World* world) {
+    static_cast<EnemyShoot*>(gameObject->behavior.get())->EnemyShoot::update(timeStep, world);
+}
+
+static void renderNothing(RenderContext& context, const ComponentStore& components, size_t row) {}
+
+static void renderSprite(RenderContext& context, const ComponentStore& components, size_t row) {
+    const Sprite& sprite = components.sprites[row];
+    const Transform& transform = components.transforms[row];
+    glm::vec2 scale = {sprite.faceRight ? -sprite.scale.x : sprite.scale.x, sprite.scale.y};
+    SpritesheetSpec frame = textureGrid(context.sheetRegions[sprite.sheet], 4, 4, sprite.frame);
+    if (context.sheetInstances) {
+        context.sheetInstances[sprite.sheet].push_back({transform.position + sprite.offset, scale, frame, glm::vec4(1.0f)});
+        return;
+    }
+    context.spriteBatch->draw(LAYER_OBJECTS, context.sheetTextures[sprite.sheet], transform.position + sprite.offset, scale,
+        frame, glm::vec4(1.0f));
+}
+
+const KindHandlers KIND_HANDLERS[KIND_COUNT] = {
+    {"Player", updateNothing, renderNothing},
+    {"Ground", updateNothing, renderNothing},
+    {"EnemyClap", updateEnemyClap, renderSprite},
+    {"EnemyShoot", updateEnemyShoot, renderSprite},
+    {"EnemyShootPiece", updateNothing, renderNothing},
+};
@@ -0,0 +1,62 @@
+#ifndef SRC_KINDS_H_INCLUDED
+#define SRC_KINDS_H_INCLUDED
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "glad/glad.h"
+#include <glm/glm.hpp>
+
+// type bits are properties that several kinds can share, tested with a single AND
+enum ObjectType : uint32_t {
+    TYPE_PLAYER = 1u << 0,
+    TYPE_GROUND = 1u << 1,
+    TYPE_ENEMY = 1u << 2
+};
+
+// a kind is what an object actually is, used to index the handler table
+enum Kind : uint8_t {
+    KIND_PLAYER, KIND_GROUND, KIND_ENEMY_CLAP, KIND_ENEMY_SHOOT, KIND_ENEMY_SHOOT_PIECE, KIND_COUNT
+};
+
+constexpr uint32_t KIND_TYPES[KIND_COUNT] = {
+    TYPE_PLAYER,                // KIND_PLAYER
+    TYPE_GROUND,                // KIND_GROUND
+    TYPE_ENEMY | TYPE_GROUND,   // KIND_ENEMY_CLAP
+    TYPE_ENEMY | TYPE_GROUND,   // KIND_ENEMY_SHOOT
+    TYPE_GROUND,                // KIND_ENEMY_SHOOT_PIECE
+};
+
+class GameObject;
+class World;
+class ComponentStore;
+class SpriteBatch;
+struct SpriteInstance;
+struct SpritesheetSpec;
+
+// sprite layers, lower layers are drawn first
+enum SpriteLayer {
+    LAYER_PLAYER, LAYER_BACKGROUND, LAYER_OBJECTS
+};
+
+// everything a render handler needs for one frame
+// with sheetInstances set, sprites are collected per sheet for one instanced draw each
+// instead of going through the sprite batch
+struct RenderContext {
+    SpriteBatch* spriteBatch;
+    const GLuint* sheetTextures;
+    const SpritesheetSpec* sheetRegions;
+    std::vector<SpriteInstance>* sheetInstances = nullptr;
+};
+
+using UpdateHandler = void (*)(GameObject* gameObject, double timeStep, World* world);
+using RenderHandler = void (*)(RenderContext& context, const ComponentStore& components, size_t row);
+
+struct KindHandlers {
+    const char* name;
+    UpdateHandler update;
+    RenderHandler render;
+};
+
+extern const KindHandlers KIND_HANDLERS[KIND_COUNT];
+
+#endif
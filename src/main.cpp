@@ -11,15 +11,47 @@
 #include <vector>
 #include "graphics/graphics.h"
 #include "graphics/simple.h"
-#include "graphics/texture.h"
-#include "graphics/texbuffer.h"
 #include "graphics/spritesheet.h"
 #include "graphics/wave.h"
+#include "graphics/spritebatch.h"
+#include "graphics/atlas.h"
+#include "graphics/program.h"
+#include "graphics/tilemap.h"
+#include "graphics/chunkmesh.h"
+#include "graphics/stream.h"
+#include "graphics/glstate.h"
+#include "graphics/renderqueue.h"
+#include "graphics/frameuniforms.h"
+#include "graphics/gputimer.h"
+#include "graphics/text.h"
 #include "util.h"
+#include "bench.h"
+#include "allocations.h"
+#include "scratch.h"
+#include "startup.h"
+#include "workers.h"
+#include "profiler.h"
+#include "hud.h"
+#include "pacing.h"
+#include "renderthread.h"
+#include "graphics/headless.h"
 #include <span>
+#include <iomanip>
+#include <random>
 #include <box2d/box2d.h>
 #define MY_PI 3.1415926535979323f
 
+// frames captured by F, written to PROFILE_PATH
+const int PROFILE_CAPTURE_FRAMES = 120;
+const char* const PROFILE_PATH = "profile.json";
+const char* const HUD_FONT = "res/DejaVuSansMono.ttf";
+const int HUD_FONT_SIZE = 14;
+// the benchmark scene: seeded chunks under the spawn point and enemies dropped onto them
+const unsigned BENCH_SEED = 1234;
+const int BENCH_CHUNKS_ACROSS = 8;
+const int BENCH_CHUNKS_DOWN = 4;
+const int BENCH_ENEMIES = 200;
+
 
 void debugGLMessage(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar *message, const void* userPtr) {
     std::cout << "OpenGL Debug Message: (src: " << source << ", type: " << type << ", id: " << id << ", sev: " << severity << ", len: " << length << ", message:\n";
@@ -30,7 +62,41 @@ void debugGLFWMessage(int error, const char* desc) {
     throw std::runtime_error(std::string("GLFW runtime error ") + std::to_string(error) + std::string(desc));
 }
 
-void Game::run() {
+// render queue layers, drawn in this order
+// setup uploads the frame's chunk changes and clears the screen before anything is drawn
+enum RenderLayer {
+    RENDER_LAYER_SETUP, RENDER_LAYER_SPRITES, RENDER_LAYER_SPRITE_INSTANCES, RENDER_LAYER_CHUNKS, RENDER_LAYER_EFFECTS, RENDER_LAYER_HUD
+};
+
+// calls draw(pos, chunk) for the chunks overlapping visible, returns how many were drawn
+// looks up the visible range when it is smaller than the map, otherwise walks the map
+template <typename T, typename F>
+static int drawVisibleChunks(const std::map<GridPos, T>& chunks, const Bounds& visible, F draw) {
+    int minX = floorInt(visible.min.x / GRID_SIZE), minY = floorInt(visible.min.y / GRID_SIZE);
+    int maxX = floorInt(visible.max.x / GRID_SIZE), maxY = floorInt(visible.max.y / GRID_SIZE);
+    int drawn = 0;
+    if (((double) maxX - minX + 1) * ((double) maxY - minY + 1) < (double) chunks.size()) {
+        for (int x = minX; x <= maxX; ++x) {
+            for (int y = minY; y <= maxY; ++y) {
+                auto p = chunks.find({x, y});
+                if (p != chunks.end()) {
+                    draw(p->first, p->second);
+                    ++drawn;
+                }
+            }
+        }
+    } else {
+        for (const auto& p : chunks) {
+            if (p.first.x >= minX && p.first.x <= maxX && p.first.y >= minY && p.first.y <= maxY) {
+                draw(p.first, p.second);
+                ++drawn;
+            }
+        }
+    }
+    return drawn;
+}
+
+void Game::openWindow() {
     glfwSetErrorCallback(debugGLFWMessage);
     if (!glfwInit())
         throw std::runtime_error("Failed to initialize GLFW");
@@ -46,6 +112,7 @@ void Game::run() {
 
     glfwMakeContextCurrent(window);
     gladLoadGLLoader((GLADloadproc) glfwGetProcAddress);
+    loadBufferStorage((GLADloadproc) glfwGetProcAddress);
     glfwSetWindowUserPointer(window, (void*) this);
     glfwGetWindowSize(window, &windowWidth, &windowHeight);
     onResize(windowWidth, windowHeight);
@@ -55,28 +122,86 @@ void Game::run() {
     glfwSetKeyCallback(window, [](GLFWwindow* window, int key, int scancode, int action, int mods){
         ((Game*) glfwGetWindowUserPointer(window))->onKey(key, scancode, action, mods);
     });
+}
+
+void Game::run(int benchFrames) {
+    StartupTimer startup;
+    nameProfileThread("main");
+    // images decode on the workers while the window is created and the shaders compile,
+    // unless the atlas is already baked in the texture cache
+    WorkerPool workers;
+    AtlasLoader atlasLoader(workers, "res");
+    if (headless) {
+        // the context is already current with its framebuffer bound
+        windowWidth = headless->width();
+        windowHeight = headless->height();
+        onResize(windowWidth, windowHeight);
+    } else {
+        openWindow();
+    }
+    if (benchFrames > 0) {
+        std::cout << "scene: " << glGetString(GL_RENDERER) << (headless ? ", headless" : "") << std::endl;
+        // the frame rate is what is being measured
+        pacing.vsync = false;
+        pacing.targetFps = 0.0;
+    }
 
     GLuint unusedIds = 0;
     glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, &unusedIds, GL_TRUE);
     glDebugMessageCallback(debugGLMessage, (const void*) this);
     glEnable(GL_BLEND);
     glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ZERO);
-    glfwSwapInterval(1);
+    startup.mark("window");
+
+    // budgets for a large world, checkMemoryBudgets warns when one is exceeded
+    setMemoryBudget(MEMORY_GRID, 64 << 20);
+    setMemoryBudget(MEMORY_PHYSICS, 128 << 20);
+    setMemoryBudget(MEMORY_RENDER, 64 << 20);
+    setMemoryBudget(MEMORY_BEHAVIOR, 64 << 20);
+    setMemoryBudget(MEMORY_GPU_BUFFERS, 256 << 20);
+    setMemoryBudget(MEMORY_GPU_TEXTURES, 256 << 20);
 
     {
-        GLuint texEnemy1 = makeNearestTexture("res/enemy1.png");
-        GLuint texEnemy2 = makeNearestTexture("res/enemy2.png");
-        GLuint tex = makeNearestTexture("res/tilesheet.png");
-        GLuint tex2 = makeNearestTexture("res/dirt2.png");
-        GLuint tex3= makeNearestTexture("res/person.png");
+        MemoryScope renderScope(MEMORY_RENDER);
         SimpleRender simpleRender;
-        TextureRender textureRender;
+        SpriteBatch spriteBatch;
         SpritesheetRender spritesheetRender;
+        std::vector<SpriteInstance> sheetInstances[SPRITE_SHEET_COUNT];
         WaveRender waveRender;
+        std::vector<WaveInstance> waveInstances;
+        // a frame is recorded into one queue while the render thread executes the other
+        RenderQueue renderQueues[2];
+        for (RenderQueue& renderQueue : renderQueues) {
+            renderQueue.nameLayer(RENDER_LAYER_SETUP, "setup pass");
+            renderQueue.nameLayer(RENDER_LAYER_SPRITES, "sprites pass");
+            renderQueue.nameLayer(RENDER_LAYER_SPRITE_INSTANCES, "sprite instances pass");
+            renderQueue.nameLayer(RENDER_LAYER_CHUNKS, "chunks pass");
+            renderQueue.nameLayer(RENDER_LAYER_EFFECTS, "effects pass");
+            renderQueue.nameLayer(RENDER_LAYER_HUD, "hud pass");
+        }
+        RenderQueue* recording = &renderQueues[0];
+        Font hudFont(HUD_FONT, HUD_FONT_SIZE);
+        Hud hud(hudFont);
+        SpriteBatch hudBatch;
+        startup.mark("shaders");
+
+        // every sprite is packed into one atlas, so the scene needs a single texture binding
+        TextureAtlas atlas = atlasLoader.load();
+        const AtlasRegion& enemy1 = atlas.region("enemy1");
+        const AtlasRegion& enemy2 = atlas.region("enemy2");
+        const AtlasRegion& tilesheet = atlas.region("tilesheet");
+        const AtlasRegion& dirt2 = atlas.region("dirt2");
+        const AtlasRegion& person = atlas.region("person");
+        GLuint tex = atlas.texture(tilesheet);
+        GLuint tex2 = atlas.texture(dirt2);
+        GLuint tex3 = atlas.texture(person);
+        GLuint sheetTextures[SPRITE_SHEET_COUNT] = {0, atlas.texture(enemy1), atlas.texture(enemy2)};
+        const SpritesheetSpec sheetRegions[SPRITE_SHEET_COUNT] = {{{0.0f, 0.0f}, {1.0f, 1.0f}}, enemy1.spec, enemy2.spec};
+        startup.mark("textures");
         float x=0.0f, y=0.0f, gx=200.0f;
 
-        double currentTime = glfwGetTime();
-        double lastTime = currentTime;
+        // swaps, vsync and input polling all happen in the pacer
+        FramePacer pacer(window, pacing);
         double delta = 0;
         double speed= 300.0f;
 
@@ -104,58 +229,168 @@ void Game::run() {
         //b2Fixture* playerFixture = playerBody->CreateFixture(&fixtureDef);
         //playerFixture->SetFriction(5.0f);
 
-        std::map<GridPos, TexturedBuffer> gridRendering;
-        std::map<GridPos, std::vector<std::unique_ptr<GameObject>>> gridHitboxes;
+        // chunks are drawn either from a tile map layer or from a vertex mesh, T switches between them
+        // both belong to the render thread, the main thread records uploads of copies of its grids
+        ChunkMeshBuffer chunkMeshes(GRID_SIZE * GRID_SIZE, TILE_SHEET_WIDTH, TILE_SHEET_HEIGHT);
+        std::map<GridPos, int> gridMeshes;
+        TileMapRender tileMapRender(GRID_SIZE, TILE_SHEET_WIDTH, TILE_SHEET_HEIGHT);
+        std::map<GridPos, int> gridLayers;
+        auto uploadChunk = [this, &recording, &chunkMeshes, &gridMeshes, &tileMapRender, &gridLayers](GridPos pos, const Grid& grid) {
+            recording->submit(renderKey(RENDER_LAYER_SETUP, 0, 0),
+                    [&chunkMeshes, &gridMeshes, &tileMapRender, &gridLayers, pos, grid, tileMap = tileMapChunks]() {
+                MemoryScope renderScope(MEMORY_RENDER);
+                if (tileMap) {
+                    auto layer = gridLayers.find(pos);
+                    if (layer == gridLayers.end()) {
+                        layer = gridLayers.insert({pos, tileMapRender.allocate()}).first;
+                    }
+                    tileMapRender.update(layer->second, std::span<const GLubyte>((const GLubyte*) grid.blocks, GRID_SIZE * GRID_SIZE));
+                    return;
+                }
+                ScratchVector<ChunkVertex> mesh = makeChunkMesh(grid);
+                auto p = gridMeshes.find(pos);
+                if (p != gridMeshes.end()) {
+                    chunkMeshes.upload(mesh, p->second);
+                } else {
+                    gridMeshes.insert({pos, chunkMeshes.upload(mesh)});
+                }
+            });
+        };
+        std::map<GridPos, ObjectArena<GameObject>> gridHitboxes;
         b2World* worldPtr = &world.box2dWorld;
         worldPtr->SetContactListener(this);
-        auto gridChangeSub = world.gridManager.gridChanges.subscribe([this, &gridRendering, &gridHitboxes, &worldPtr](std::pair<GridPos, Grid> grid) {
-            std::vector<GLfloat> testBuffer = makeTexturedBuffer(grid.second);
-            auto p = gridRendering.find(grid.first);
-            if (p != gridRendering.end()) {
-                p->second.rebuild(testBuffer);
-            } else {
-                gridRendering.insert({grid.first, TexturedBuffer(testBuffer)});
-            }
-            gridHitboxes[grid.first] = std::move(makeGround(&world, grid.first, grid.second));
+        auto gridChangeSub = world.gridManager.gridChanges.subscribe([this, &uploadChunk, &gridHitboxes, &worldPtr](std::pair<GridPos, Grid> grid) {
+            PROFILE_ZONE("chunk rebuild");
+            uploadChunk(grid.first, grid.second);
+            MemoryScope physicsScope(MEMORY_PHYSICS);
+            auto hitboxes = gridHitboxes.try_emplace(grid.first, GRID_SIZE * GRID_SIZE).first;
+            makeGround(&world, grid.first, grid.second, hitboxes->second);
         });
         world.gridManager.set(1, 0, 0);
 
-        world.camera.zoom(16.0f);
+        // the benchmark scene goes through the same grid changes and constructors as the game's own
+        std::vector<std::unique_ptr<GameObject>> benchEnemies;
+        if (benchFrames > 0) {
+            std::default_random_engine random(BENCH_SEED);
+            std::uniform_int_distribution<int> block(0, 3);
+            for (int x = -BENCH_CHUNKS_ACROSS / 2; x < BENCH_CHUNKS_ACROSS / 2; ++x) {
+                for (int y = 0; y < BENCH_CHUNKS_DOWN; ++y) {
+                    Grid grid;
+                    for (BlockType& cell : grid.blocks) {
+                        cell = (BlockType) block(random);
+                    }
+                    world.gridManager.setGrid(grid, x, y);
+                }
+            }
+            const float across = (float) (BENCH_CHUNKS_ACROSS * GRID_SIZE) / 2.0f;
+            std::uniform_real_distribution<float> enemyX(-across, across), enemyY(-30.0f, -2.0f);
+            for (int i = 0; i < BENCH_ENEMIES; ++i) {
+                glm::vec2 position = {enemyX(random), enemyY(random)};
+                benchEnemies.push_back(i % 2 ? makeEnemyShoot(&world, position) : makeEnemyClap(&world, position));
+            }
+        }
 
-        while (!glfwWindowShouldClose(window)) {
-            currentTime = glfwGetTime();
-            delta = currentTime - lastTime;
-            lastTime = currentTime;
+        world.camera.zoom(16.0f);
+        startup.mark("world");
+        bool firstFrame = true;
+        // the pacer's stats as of the last finished frame, the render thread writes the live ones
+        PacingStats pacingStats;
+
+        // everything GL from here on runs on the render thread, declared last so it hands the context back
+        // before the renders above are destroyed
+        std::unique_ptr<RenderThread> renderThreadOwner = headless ? std::make_unique<RenderThread>(headless)
+            : std::make_unique<RenderThread>(window);
+        RenderThread& renderThread = *renderThreadOwner;
+
+        // benchmark frames are printed a frame late, the render thread's numbers are only in once it is done
+        // the first half draws chunks from the tile map, the second half from meshes
+        double benchRecordTotal = 0.0, benchExecuteTotal = 0.0;
+        int benchDrawCallTotal = 0, benchAveraged = 0;
+        auto printBenchFrame = [&](int frame, double recordMs, const RenderFrameStats& stats) {
+            if (frame == 0 || frame == benchFrames / 2) {
+                std::cout << (frame == 0 ? "  tile map chunks\n" : "  mesh chunks\n");
+                std::cout << "  frame  record ms  execute ms  draw calls  checksum\n";
+            }
+            std::cout << "  " << std::setw(5) << frame << "  " << std::fixed << std::setprecision(3) << std::setw(9) << recordMs
+                << "  " << std::setw(10) << stats.executeMs << "  " << std::setw(10) << stats.drawCalls << "  " << std::hex
+                << std::setw(16) << std::setfill('0') << stats.checksum << std::dec << std::setfill(' ') << "\n";
+            benchRecordTotal += recordMs;
+            benchExecuteTotal += stats.executeMs;
+            benchDrawCallTotal += stats.drawCalls;
+            ++benchAveraged;
+            if (frame == benchFrames / 2 - 1 || frame == benchFrames - 1) {
+                std::cout << "  average: " << benchRecordTotal / benchAveraged << " ms recording, " << benchExecuteTotal / benchAveraged
+                    << " ms executing, " << (double) benchDrawCallTotal / benchAveraged << " draw calls" << std::endl;
+                benchRecordTotal = benchExecuteTotal = 0.0;
+                benchDrawCallTotal = benchAveraged = 0;
+            }
+            std::cout.unsetf(std::ios::fixed);
+        };
+        double lastRecordMs = 0.0;
+        int frame = 0;
+        while (benchFrames > 0 ? frame < benchFrames : !glfwWindowShouldClose(window)) {
+            AllocationCounters frameStartAllocations = allocationCounters();
+            MemoryReport frameStartMemory = memoryReport();
+            delta = pacer.beginFrame();
+            uint64_t recordStart = profileNow();
+            if (benchFrames > 0) {
+                // a fixed step keeps the simulation, and so the checksums, the same from run to run
+                delta = 1.0 / 60.0;
+                if (frame == benchFrames / 2) {
+                    tileMapChunks = false;
+                    chunkModeChanged = true;
+                }
+            }
             float deltaf = (float) delta;
-            int er = glGetError();
-            if (er != 0) {
-                std::cerr << er << std::endl;
+            if (chunkModeChanged) {
+                chunkModeChanged = false;
+                recording->submit(renderKey(RENDER_LAYER_SETUP, 0, 0), [&chunkMeshes, &gridMeshes, &tileMapRender, &gridLayers]() {
+                    for (const auto& p : gridMeshes) {
+                        chunkMeshes.release(p.second);
+                    }
+                    gridMeshes.clear();
+                    for (const auto& p : gridLayers) {
+                        tileMapRender.release(p.second);
+                    }
+                    gridLayers.clear();
+                });
+                for (const auto& p : world.gridManager.grids) {
+                    uploadChunk(p.first, p.second);
+                }
             }
 
             //std::cout << "Player on ground: " << player->onGround << std::endl;
 
-            double mx, my;
-            glfwGetCursorPos(window, &mx, &my);
-            glm::vec2 mousePos = {mx, my};
+            if (window) {
+                PROFILE_ZONE("input");
+                double mx, my;
+                glfwGetCursorPos(window, &mx, &my);
+                glm::vec2 mousePos = {mx, my};
 
-            glm::vec2 mouseWorldPos = world.camera.toWorldCoordinate(mousePos);
+                glm::vec2 mouseWorldPos = world.camera.toWorldCoordinate(mousePos);
 
-            // draw on the grid with the mouse
-            if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS) {
-                world.gridManager.set(1, floorInt(mouseWorldPos.x), floorInt(mouseWorldPos.y));
-            }
-            if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_RIGHT) == GLFW_PRESS) {
-                world.gridManager.set(air, floorInt(mouseWorldPos.x), floorInt(mouseWorldPos.y));
+                // draw on the grid with the mouse
+                if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS) {
+                    world.gridManager.set(1, floorInt(mouseWorldPos.x), floorInt(mouseWorldPos.y));
+                }
+                if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_RIGHT) == GLFW_PRESS) {
+                    world.gridManager.set(air, floorInt(mouseWorldPos.x), floorInt(mouseWorldPos.y));
+                }
             }
 
             if (!paused) physicsTime += delta;
             double timeStep = 1.0 / 60.0f;
-            while (physicsTime > timeStep) {
-                world.update(timeStep, window);
-                physicsTime -= timeStep;
+            int ticks = 0;
+            {
+                PROFILE_ZONE("physics");
+                while (physicsTime > timeStep) {
+                    world.update(timeStep, window);
+                    physicsTime -= timeStep;
+                    ++ticks;
+                }
             }
+            totalTicks += ticks;
             //start rendering
-            glClear(GL_COLOR_BUFFER_BIT);
 
             b2Vec2 playerPos = world.player->rigidBody->GetPosition();
             world.camera.center(playerPos.x, playerPos.y);
@@ -170,127 +405,225 @@ void Game::run() {
                 playerRenderBox.scale = {-playerScale, playerScale};
             }
 
-            glm::mat4 playerMatrix;
-            playerMatrix = glm::translate(glm::mat4(1.0f), glm::vec3(playerRenderBox.position.x, playerRenderBox.position.y, 0));
-            playerMatrix = glm::rotate(playerMatrix, world.player->rigidBody->GetAngle(), glm::vec3(0, 0, 1));
-            playerMatrix = glm::scale(playerMatrix, glm::vec3(playerRenderBox.scale.x, playerRenderBox.scale.y, 0));
-            glm::mat4 hitboxMatrix = toMatrix(Box{glm::vec2(world.player->rigidBody->GetPosition().x, world.player->rigidBody->GetPosition().y), ((BoxBodyType*) world.player->bodyType.get())->scale});
-            glBindTexture(GL_TEXTURE_2D, tex3);
-//            simpleRender.render(proj * camera.getView() * hitboxMatrix, glm::vec4(1.0f));
-            textureRender.render(proj * world.camera.getView() * playerMatrix, glm::vec4(1.0f, 1.0f, 1.0f, 1.0f), 0);
+            // after this frame's chunk uploads, which were submitted to the same layer during physics
+            recording->submit(renderKey(RENDER_LAYER_SETUP, 0, 0),
+                    [width = windowWidth, height = windowHeight, viewProjection = proj * world.camera.getView()]() {
+                glViewport(0, 0, width, height);
+                glClear(GL_COLOR_BUFFER_BIT);
+                // the one view projection every draw this frame uses
+                setFrameUniforms({viewProjection});
+            });
+            spriteBatch.begin();
+            Box hitbox = Box{glm::vec2(world.player->rigidBody->GetPosition().x, world.player->rigidBody->GetPosition().y), ((BoxBodyType*) world.player->bodyType.get())->scale};
+//            simpleRender.render(hitbox.position, hitbox.scale, glm::vec4(1.0f));
+            spriteBatch.draw(LAYER_PLAYER, tex3, playerRenderBox.position, playerRenderBox.scale, person.spec,
+                glm::vec4(1.0f, 1.0f, 1.0f, 1.0f), world.player->rigidBody->GetAngle());
 
             Box groundBox;
             b2Vec2 groundPos = world.ground->rigidBody->GetPosition();
             b2Vec2 groundScale = {20, 10};
             groundBox.position = {groundPos.x, groundPos.y};
             groundBox.scale = {groundScale.x, groundScale.y};
-            glm::mat4 groundMatrix = toMatrix(groundBox);
-            glBindTexture(GL_TEXTURE_2D, tex2);
-            textureRender.render(proj * world.camera.getView() * groundMatrix, glm::vec4(1.0f, 1.0f, 1.0f, 1.0f), 0);
-
-            for (GameObject* gameObject : world.gameObjects) {
-                if (gameObject->name == "EnemyClap") {
-                    EnemyClap* enemy = reinterpret_cast<EnemyClap*>(gameObject->behavior.get());
-                    Box enemyRenderBox = {
-                        {gameObject->rigidBody->GetPosition().x, gameObject->rigidBody->GetPosition().y - 0.5f},
-                        {gameObject->faceRight ? -2.0f : 2.0f, 2.0f}
-                    };
-                    int enemyFrame = 0;
-                    switch (enemy->mode) {
-                        case EnemyClap::ASLEEP:
-                            enemyFrame = constrain((int) (enemy->timer / (0.5f / 2)), 0, 1);
-                            break;
-                        case EnemyClap::AWAKE:
-                            enemyFrame = constrain((int) (2 + enemy->timer / (0.2f / 2)), 2, 3);
-                            break;
-                        case EnemyClap::ATTACKED:
-                            enemyFrame = constrain((int) (5 - (enemy->timer - 0.8f) / (0.2f / 2)), 3, 4);
-                            break;
-                    }
-                    glm::mat4 enemyMatrix;
-                    enemyMatrix = toMatrix(enemyRenderBox);
-                    glBindTexture(GL_TEXTURE_2D, texEnemy1);
-                    spritesheetRender.render(proj * world.camera.getView() * enemyMatrix, glm::vec4(1.0f), 0, textureGrid(4, 4, enemyFrame));
-                }
+            spriteBatch.draw(LAYER_BACKGROUND, tex2, groundBox.position, groundBox.scale, dirt2.spec, glm::vec4(1.0f, 1.0f, 1.0f, 1.0f));
 
-                if (gameObject->name == "EnemyShoot") {
-                    EnemyShoot* enemy = reinterpret_cast<EnemyShoot*>(gameObject->behavior.get());
-                    Box enemyRenderBox = {
-                        {gameObject->rigidBody->GetPosition().x, gameObject->rigidBody->GetPosition().y - 0.5f},
-                        {gameObject->faceRight ? -2.0f : 2.0f, 2.0f}
-                    };
-                    int enemyFrame = 0;
-                    switch (enemy->mode) {
-                        case EnemyShoot::ASLEEP:
-                            enemyFrame = constrain((int) (enemy->timer / (0.5f / 2)), 0, 1);
-                            break;
-                        case EnemyShoot::PRESHOOT:
-                            enemyFrame = constrain((int) (2 + enemy->timer / (0.2f / 2)), 2, 3);
-                            break;
-                        case EnemyShoot::POSTSHOOT:
-                            enemyFrame = constrain((int) (5 - (enemy->timer - 0.8f) / (0.2f / 2)), 3, 4);
-                            break;
-                    }
-                    glm::mat4 enemyMatrix;
-                    enemyMatrix = toMatrix(enemyRenderBox);
-                    glBindTexture(GL_TEXTURE_2D, texEnemy2);
-                    spritesheetRender.render(proj * world.camera.getView() * enemyMatrix, glm::vec4(1.0f), 0, textureGrid(4, 4, enemyFrame));
-                }
-
-                if (gameObject->name == "EnemyShootPiece") {
-                    Box renderBox = {
-                        {gameObject->rigidBody->GetPosition().x, gameObject->rigidBody->GetPosition().y},
-                        {gameObject->faceRight ? -2.0f : 2.0f, 2.0f}
-                    };
-                    int enemyFrame = 0;
-                    switch (enemy->mode) {
-                        case EnemyShoot::ASLEEP:
-                            enemyFrame = constrain((int) (enemy->timer / (0.5f / 2)), 0, 1);
-                            break;
-                        case EnemyShoot::PRESHOOT:
-                            enemyFrame = constrain((int) (2 + enemy->timer / (0.2f / 2)), 2, 3);
-                            break;
-                        case EnemyShoot::POSTSHOOT:
-                            enemyFrame = constrain((int) (5 - (enemy->timer - 0.8f) / (0.2f / 2)), 3, 4);
-                            break;
-                    }
-                    glm::mat4 enemyMatrix;
-                    enemyMatrix = toMatrix(enemyRenderBox);
-                    glBindTexture(GL_TEXTURE_2D, texEnemy2);
-                    spritesheetRender.render(proj * world.camera.getView() * enemyMatrix, glm::vec4(1.0f), 0, textureGrid(4, 4, enemyFrame));
+            RenderContext renderContext = {&spriteBatch, sheetTextures, sheetRegions};
+            if (instancedSprites) {
+                for (std::vector<SpriteInstance>& instances : sheetInstances) {
+                    instances.clear();
                 }
+                renderContext.sheetInstances = sheetInstances;
             }
-
-            for (const auto& p : gridRendering) {
-                GridPos pos = p.first;
-                const TexturedBuffer& draw = p.second;
-                Box gridBox;
-                gridBox.position = {pos.x * GRID_SIZE, pos.y * GRID_SIZE};
-                gridBox.scale = {GRID_SIZE, GRID_SIZE};
-                glBindTexture(GL_TEXTURE_2D, tex);
-                draw.render(proj * world.camera.getView() * toMatrix(gridBox), glm::vec4(1.0f), 0);
+            const Bounds visible = world.camera.visibleBounds();
+            VisibilityStats visibility;
+            const ComponentStore& components = world.components;
+            ScratchVector<Entity> visibleEntities = scratchVector<Entity>();
+            world.objectIndex.query(visible, visibleEntities);
+            for (Entity entity : visibleEntities) {
+                size_t row = components.row(entity);
+                KIND_HANDLERS[components.kinds[row]].render(renderContext, components, row);
+            }
+            visibility.objectsVisible = (int) visibleEntities.size();
+            visibility.objectsCulled = (int) (world.objectIndex.size() - visibleEntities.size());
+            // nothing is drawn until the render thread executes the queue, sorted by layer, program and texture
+            // commands only see what was copied into the queue, the main thread reuses its buffers for the next frame
+            SpriteBatch::Prepared sprites = spriteBatch.prepare(recording->memory());
+            recording->submit(renderKey(RENDER_LAYER_SPRITES, spriteBatch.program(), 0), [this, &spriteBatch, sprites]() {
+                spriteBatch.draw(sprites);
+                renderStats.drawCalls += spriteBatch.stats().drawCalls;
+            });
+            if (instancedSprites) {
+                for (int sheet = 0; sheet < SPRITE_SHEET_COUNT; ++sheet) {
+                    GLuint texture = sheetTextures[sheet];
+                    std::span<const SpriteInstance> instances = recording->copy(std::span<const SpriteInstance>(sheetInstances[sheet]));
+                    recording->submit(renderKey(RENDER_LAYER_SPRITE_INSTANCES, spritesheetRender.program(), texture),
+                            [this, &spritesheetRender, texture, instances]() {
+                        glState().bindTexture(0, GL_TEXTURE_2D, texture);
+                        spritesheetRender.render(0, instances);
+                        ++renderStats.drawCalls;
+                    });
+                }
             }
 
+            // the chunk maps belong to the render thread, so it is also the one that culls them
+            recording->submit(renderKey(RENDER_LAYER_CHUNKS, tileMapRender.program(), tex),
+                    [this, &tileMapRender, &gridLayers, &chunkMeshes, &gridMeshes, visible, tex, sheet = tilesheet.spec]() {
+                glState().bindTexture(0, GL_TEXTURE_2D, tex);
+                int tileChunksDrawn = drawVisibleChunks(gridLayers, visible, [&](GridPos pos, int layer) {
+                    tileMapRender.render(glm::vec2(pos.x * GRID_SIZE, pos.y * GRID_SIZE), GRID_SIZE, glm::vec4(1.0f), 0, layer, sheet);
+                });
+                chunkMeshes.begin();
+                int meshChunksDrawn = drawVisibleChunks(gridMeshes, visible, [&](GridPos pos, int mesh) {
+                    chunkMeshes.add(mesh, glm::vec2(pos.x * GRID_SIZE, pos.y * GRID_SIZE));
+                });
+                chunkMeshes.end(glm::vec4(1.0f), 0, sheet);
+                renderStats.chunkMeshes = chunkMeshes.stats();
+                renderStats.chunksVisible = tileChunksDrawn + meshChunksDrawn;
+                renderStats.chunksCulled = (int) (gridLayers.size() + gridMeshes.size()) - renderStats.chunksVisible;
+                renderStats.drawCalls += tileChunksDrawn + renderStats.chunkMeshes.drawCalls;
+            });
+            // from the last frame the render thread finished
+            visibility.chunksVisible = lastRenderStats.chunksVisible;
+            visibility.chunksCulled = lastRenderStats.chunksCulled;
+
+            waveInstances.clear();
             for (Wave wave : world.waves) {
-                Box bounds;
-                bounds.position = wave.center;
-                bounds.scale.x = std::max(0.1f, wave.timer) * 15.0f;
-                bounds.scale.y = bounds.scale.x;
-                float relativeRadius = wave.timer < 0.1f ? wave.timer / 0.1f * 0.4f : 0.4f;
-                float relativeThickness = wave.timer < 0.1f ? 0.2f : 0.2f * 1.0f / bounds.scale.x;
+                // the ring grows to 0.4 of a 15 unit circle in the first 0.1 s, then widens with the timer
+                float size = std::max(0.1f, wave.timer) * 15.0f;
+                float radius = wave.timer < 0.1f ? wave.timer / 0.1f * 0.4f * size : 0.4f * size;
+                float thickness = wave.timer < 0.1f ? 0.2f * size : 0.2f;
+                glm::vec2 extent = glm::vec2(radius + thickness);
+                if (!visible.overlaps({wave.center - extent, wave.center + extent})) {
+                    ++visibility.wavesCulled;
+                    continue;
+                }
+                ++visibility.wavesVisible;
                 float transparency = constrain(wave.timer < 0.8f ? 1.0f : 1.0f - (wave.timer - 0.8f) / 0.2f, 0.0f, 1.0f) * 0.8f;
-
-                glm::mat4 waveMatrix = toMatrix(bounds);
-                waveRender.render(proj * world.camera.getView() * waveMatrix, glm::vec4(1.0f, 1.0f, 1.0f, transparency), relativeRadius, relativeThickness);
-                //waveRender.render(glm::mat4(1.0f), glm::vec4(1.0f, 1.0f, 1.0f, transparency), relativeRadius, relativeThickness);
+                waveInstances.push_back({wave.center, radius, thickness, glm::vec4(1.0f, 1.0f, 1.0f, transparency)});
+            }
+            recording->submit(renderKey(RENDER_LAYER_EFFECTS, waveRender.program(), 0),
+                    [this, &waveRender, waves = recording->copy(std::span<const WaveInstance>(waveInstances))]() {
+                waveRender.render(waves);
+                renderStats.drawCalls += waves.empty() ? 0 : 1;
+            });
+            if (benchFrames > 0) {
+                // read back before the HUD, whose numbers change with timing
+                recording->submit(renderKey(RENDER_LAYER_HUD, 0, 0), [this, width = windowWidth, height = windowHeight]() {
+                    uint64_t start = profileNow();
+                    renderStats.checksum = framebufferChecksum(width, height);
+                    renderStats.readbackMs = (profileNow() - start) / 1e6;
+                });
+            }
+            uint64_t hudStart = profileNow();
+            if (showHud) {
+                PROFILE_ZONE("hud");
+                hud.addFrame(delta * 1000.0);
+                HudCounters counters;
+                counters.ticks = ticks;
+                counters.totalTicks = totalTicks;
+                counters.drawCalls = lastRenderStats.drawCalls;
+                counters.commands = lastRenderStats.commands;
+                counters.bodies = world.box2dWorld.GetBodyCount();
+                counters.objects = (int) components.size();
+                counters.chunks = lastRenderStats.chunksVisible;
+                counters.hudMs = lastHudMs;
+                counters.pacing = pacingStats;
+                counters.pacingSettings = pacer.settings();
+                hudBatch.begin();
+                hud.draw(hudBatch, 0, counters);
+                SpriteBatch::Prepared hudSprites = hudBatch.prepare(recording->memory());
+                // screen pixels, the last thing drawn this frame
+                recording->submit(renderKey(RENDER_LAYER_HUD, hudBatch.program(), hudFont.texture()),
+                        [this, &hudBatch, &hudFont, hudSprites, screen = proj]() {
+                    uint64_t start = profileNow();
+                    // glyphs the HUD rasterized on the main thread for the first time
+                    hudFont.upload();
+                    setFrameUniforms({screen});
+                    hudBatch.draw(hudSprites);
+                    renderStats.drawCalls += hudBatch.stats().drawCalls;
+                    renderStats.hudDrawMs = (profileNow() - start) / 1e6;
+                });
+            }
+            double hudBuildMs = (profileNow() - hudStart) / 1e6;
+            double recordMs = (profileNow() - recordStart) / 1e6;
+
+            // one frame in flight: the last one has to finish before this one starts drawing,
+            // everything the render thread shares with the main thread is handed over here
+            renderThread.wait();
+            lastRenderStats = renderStats;
+            lastHudMs = showHud ? hudBuildMs + lastRenderStats.hudDrawMs : 0.0;
+            pacingStats = pacer.stats();
+            if (pacingChanged) {
+                pacingChanged = false;
+                pacer.setSettings(pacing);
+            }
+            // the first frame counts as done once the render thread has presented it, not when it was submitted
+            if (firstFrame && lastRenderStats.presented != std::chrono::steady_clock::time_point()) {
+                firstFrame = false;
+                startup.mark("first frame", lastRenderStats.presented);
+                startup.print(std::cout);
+                const ProgramCacheStats& programs = programCacheStats();
+                std::cout << "  programs: " << programs.binaryLoads << " from the binary cache, " << programs.compiled
+                    << " compiled (" << programs.binaryRejected << " rejected binaries), " << programs.milliseconds << " ms" << std::endl;
+                const AtlasLoadStats& images = atlasLoader.stats();
+                if (images.cached) {
+                    std::cout << "  images: " << images.images << " loaded from the texture cache" << std::endl;
+                } else {
+                    std::cout << "  images: " << images.images << " decoded on " << images.threads << " threads, " << images.decodeMs
+                        << " ms of decoding, " << images.waitMs << " ms waited for, " << images.bakeMs << " ms baking the cache" << std::endl;
+                }
             }
 
-            glfwSwapBuffers(window);
-            glfwPollEvents();
+            if (benchFrames > 0 && frame > 0) {
+                printBenchFrame(frame - 1, lastRecordMs, lastRenderStats);
+            }
+            lastRecordMs = recordMs;
+
+            profileFrame();
+            renderThread.submit([this, &pacer, queue = recording, inputTime = pacer.inputSampled()]() {
+                renderStats = RenderFrameStats();
+                uint64_t executeStart = profileNow();
+                {
+                    PROFILE_ZONE("render queue");
+                    renderStats.commands = queue->execute();
+                }
+                renderStats.executeMs = (profileNow() - executeStart) / 1e6 - renderStats.readbackMs;
+                int er = glGetError();
+                if (er != 0) {
+                    std::cerr << er << std::endl;
+                }
+                pacer.endFrame(inputTime);
+                renderStats.presented = std::chrono::steady_clock::now();
+                frameStream().endFrame();
+                collectGpuZones();
+                renderStats.glState = glState().takeStats();
+                renderStats.stream = frameStream().stats();
+                renderStats.persistentStream = frameStream().persistent();
+                frameScratch().reset();
+            });
+            recording = recording == &renderQueues[0] ? &renderQueues[1] : &renderQueues[0];
+
+            lastFrameVisibility = visibility;
+            lastFrameAllocations = allocationCounters() - frameStartAllocations;
+            lastFrameScratch = frameScratch().used();
+            frameScratch().reset();
+            lastFrameStartMemory = frameStartMemory;
+            lastFrameEndMemory = memoryReport();
+            checkMemoryBudgets();
+            ++frame;
+        }
+        if (benchFrames > 0) {
+            renderThread.wait();
+            printBenchFrame(frame - 1, lastRecordMs, renderStats);
         }
     }
 
-    glfwTerminate();
+    releaseGpuZones();
+    releaseFrameStream();
+    releasePrograms();
+    glState().invalidate();
+    if (window) {
+        glfwTerminate();
+    }
 }
 
 void Game::move(float &x, float &y, float deltaf, float speed){
@@ -319,8 +652,8 @@ void Game::move(float &x, float &y, float deltaf, float speed){
                 y+= speed*deltaf;
          }
 }
+// called from glfwPollEvents() on the main thread, the viewport is set by the next frame's setup command
 void Game::onResize(int width, int height) {
-    glViewport(0, 0, width, height);
     windowWidth = width;
     windowHeight = height;
     proj = glm::ortho<float>(0, width, height, 0, 0, 1);
@@ -344,6 +677,65 @@ void Game::onKey(int key, int scancode, int action, int mods) {
     if (key == GLFW_KEY_N && action == GLFW_PRESS) {
         physicsTime += 1.0 / 60.0;
     }
+    if (key == GLFW_KEY_T && action == GLFW_PRESS) {
+        tileMapChunks = !tileMapChunks;
+        chunkModeChanged = true;
+        std::cout << "Chunks: " << (tileMapChunks ? "tile map" : "vertex meshes") << std::endl;
+    }
+    if (key == GLFW_KEY_I && action == GLFW_PRESS) {
+        instancedSprites = !instancedSprites;
+        std::cout << "Enemy sprites: " << (instancedSprites ? "instanced" : "sprite batch") << std::endl;
+    }
+    if (key == GLFW_KEY_F && action == GLFW_PRESS) {
+        startProfileCapture(PROFILE_CAPTURE_FRAMES, PROFILE_PATH);
+        std::cout << "Profiling the next " << PROFILE_CAPTURE_FRAMES << " frames into " << PROFILE_PATH << std::endl;
+    }
+    if (key == GLFW_KEY_V && action == GLFW_PRESS) {
+        pacing.vsync = !pacing.vsync;
+        pacingChanged = true;
+        std::cout << "Vsync: " << (pacing.vsync ? "on" : "off") << std::endl;
+    }
+    if (key == GLFW_KEY_L && action == GLFW_PRESS) {
+        const double limits[] = {0.0, 30.0, 60.0, 120.0, 144.0};
+        const int count = sizeof(limits) / sizeof(limits[0]);
+        int next = 0;
+        for (int i = 0; i < count; ++i) {
+            if (limits[i] == pacing.targetFps) {
+                next = (i + 1) % count;
+            }
+        }
+        pacing.targetFps = limits[next];
+        pacingChanged = true;
+        std::cout << "Frame limit: " << (pacing.targetFps > 0.0 ? std::to_string((int) pacing.targetFps) + " fps" : "off") << std::endl;
+    }
+    if (key == GLFW_KEY_Q && action == GLFW_PRESS) {
+        pacing.maxQueuedFrames = (pacing.maxQueuedFrames + 1) % 3;
+        pacingChanged = true;
+        std::cout << "Queued frames: " << pacing.maxQueuedFrames << (pacing.maxQueuedFrames == 0 ? " (glFinish)" : "") << std::endl;
+    }
+    if (key == GLFW_KEY_H && action == GLFW_PRESS) {
+        showHud = !showHud;
+    }
+    if (key == GLFW_KEY_M && action == GLFW_PRESS) {
+        std::cout << "Last frame: " << lastFrameAllocations.allocations << " heap allocations, "
+            << lastFrameAllocations.frees << " frees, " << lastFrameScratch << " scratch bytes (high water "
+            << frameScratch().highWater() << " of " << frameScratch().capacity() << ")" << std::endl;
+        printMemoryReport(lastFrameEndMemory, lastFrameStartMemory);
+        const VisibilityStats& v = lastFrameVisibility;
+        std::cout << "Visible: " << v.chunksVisible << " chunks (" << v.chunksCulled << " culled), "
+            << v.objectsVisible << " objects (" << v.objectsCulled << " culled), "
+            << v.wavesVisible << " waves (" << v.wavesCulled << " culled)" << std::endl;
+        const StreamStats& stream = lastRenderStats.stream;
+        std::cout << "Streamed: " << stream.bytes << " bytes, " << stream.stalls << " stalls (" << stream.stallMs << " ms), "
+            << stream.reallocations << " reallocations, " << (lastRenderStats.persistentStream ? "persistent mapping" : "orphaning") << std::endl;
+        const GLStateStats& state = lastRenderStats.glState;
+        std::cout << "Render queue: " << lastRenderStats.commands << " commands, binds made/avoided: programs " << state.programBinds << "/"
+            << state.programBindsAvoided << ", vertex arrays " << state.vertexArrayBinds << "/" << state.vertexArrayBindsAvoided
+            << ", textures " << state.textureBinds << "/" << state.textureBindsAvoided << std::endl;
+        const ChunkMeshStats& meshes = lastRenderStats.chunkMeshes;
+        std::cout << "Chunk meshes: " << meshes.usedVertices << " vertices, " << meshes.vertexBytes << " bytes (6 float vertices per cell: "
+            << meshes.unpackedBytes << " bytes)" << std::endl;
+    }
 }
 
 void Game::onGLDebugMessage(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar *message) {
@@ -351,8 +743,15 @@ void Game::onGLDebugMessage(GLenum source, GLenum type, GLuint id, GLenum severi
     std::cout << message << std::endl;
 }
 
-int main() {
+int main(int argc, char** argv) {
     try {
+        if (argc > 2 && std::string_view(argv[1]) == "--bench") {
+            bool headless = argc > 3 && std::string_view(argv[3]) == "--headless";
+            if (!runBenchmark(argv[2], headless)) {
+                std::cerr << "Unknown benchmark: " << argv[2] << std::endl;
+            }
+            return 0;
+        }
         Game().run();
     } catch (const std::exception& e) {
         std::cerr << "Error! Exiting program. Info: " << e.what() << std::endl;
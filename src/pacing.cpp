@@ -0,0 +1,122 @@
+#include "pacing.h"
+#include "profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+// the limiter stops sleeping this long before the deadline and spins the rest
+const uint64_t PACING_SPIN_NS = 1500000;
+// a limiter that fell further behind than this starts counting from now instead of catching up
+const int PACING_MAX_LATE_FRAMES = 2;
+
+static double msBetween(uint64_t start, uint64_t end) {
+    return (double) (end - start) / 1e6;
+}
+
+FramePacer::FramePacer(GLFWwindow* window, PacingSettings settings) : window(window) {
+    setSettings(settings);
+}
+
+FramePacer::~FramePacer() {
+    for (const InFlight& frame : inFlight) {
+        glDeleteSync(frame.fence);
+    }
+}
+
+void FramePacer::setSettings(PacingSettings settings) {
+    swapIntervalChanged = swapIntervalChanged || settings.vsync != current.vsync;
+    current = settings;
+    deadline = 0;
+}
+
+double FramePacer::beginFrame() {
+    uint64_t now = profileNow();
+    lastStats.sleepMs = lastStats.spinMs = 0.0;
+    if (current.targetFps > 0.0) {
+        uint64_t period = (uint64_t) (1e9 / current.targetFps);
+        deadline = deadline == 0 || now > deadline + PACING_MAX_LATE_FRAMES * period ? now : deadline + period;
+        if (deadline > now + PACING_SPIN_NS) {
+            PROFILE_ZONE("limiter sleep");
+            std::this_thread::sleep_for(std::chrono::nanoseconds(deadline - now - PACING_SPIN_NS));
+        }
+        uint64_t spinStart = profileNow();
+        lastStats.sleepMs = msBetween(now, spinStart);
+        {
+            PROFILE_ZONE("limiter spin");
+            while (profileNow() < deadline) {
+                std::this_thread::yield();
+            }
+        }
+        now = profileNow();
+        lastStats.spinMs = msBetween(spinStart, now);
+    }
+
+    if (window) {
+        PROFILE_ZONE("poll events");
+        glfwPollEvents();
+    }
+    inputTime = profileNow();
+
+    double seconds = frameStart == 0 ? 0.0 : (double) (now - frameStart) / 1e9;
+    if (frameStart != 0) {
+        lastStats.frameMs = seconds * 1000.0;
+        frameTimes[nextFrameTime] = lastStats.frameMs;
+        nextFrameTime = (nextFrameTime + 1) % PACING_WINDOW_FRAMES;
+        frameTimeCount = std::min(frameTimeCount + 1, PACING_WINDOW_FRAMES);
+        double sum = 0.0, squares = 0.0;
+        for (int i = 0; i < frameTimeCount; ++i) {
+            sum += frameTimes[i];
+            squares += frameTimes[i] * frameTimes[i];
+        }
+        lastStats.meanMs = sum / frameTimeCount;
+        lastStats.deviationMs = std::sqrt(std::max(0.0, squares / frameTimeCount - lastStats.meanMs * lastStats.meanMs));
+        if (profiling()) {
+            uint64_t at = profileNow();
+            recordCounter("frame ms", at, lastStats.frameMs);
+            recordCounter("frame deviation ms", at, lastStats.deviationMs);
+        }
+    }
+    frameStart = now;
+    return seconds;
+}
+
+bool FramePacer::finish(const InFlight& frame, uint64_t timeout) {
+    GLenum result = glClientWaitSync(frame.fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout);
+    if (result == GL_TIMEOUT_EXPIRED) {
+        return false;
+    }
+    uint64_t now = profileNow();
+    lastStats.inputLatencyMs = msBetween(frame.inputTime, now);
+    if (profiling()) {
+        recordCounter("input latency ms", now, lastStats.inputLatencyMs);
+    }
+    glDeleteSync(frame.fence);
+    return true;
+}
+
+void FramePacer::endFrame(uint64_t inputTime) {
+    if (window && swapIntervalChanged) {
+        swapIntervalChanged = false;
+        glfwSwapInterval(current.vsync ? 1 : 0);
+    }
+    if (window) {
+        PROFILE_ZONE("swap buffers");
+        glfwSwapBuffers(window);
+    }
+    uint64_t start = profileNow();
+    PROFILE_ZONE("queue wait");
+    if (current.maxQueuedFrames <= 0) {
+        glFinish();
+    }
+    inFlight.push_back({glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), inputTime});
+    // frames that already finished only need their latency read
+    while (!inFlight.empty() && finish(inFlight.front(), 0)) {
+        inFlight.pop_front();
+    }
+    while ((int) inFlight.size() > current.maxQueuedFrames) {
+        while (!finish(inFlight.front(), UINT64_MAX)) {}
+        inFlight.pop_front();
+    }
+    lastStats.queueWaitMs = msBetween(start, profileNow());
+}
@@ -0,0 +1,87 @@
+#ifndef SRC_PACING_H_INCLUDED
+#define SRC_PACING_H_INCLUDED
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include <array>
+#include <cstdint>
+#include <deque>
+
+// frames the variance is measured over
+const int PACING_WINDOW_FRAMES = 120;
+
+struct PacingSettings {
+    bool vsync = true;
+    // 0 for no limit
+    double targetFps = 0.0;
+    // frames the GPU may still be working on when the CPU starts the next one,
+    // 0 waits for every frame with glFinish
+    int maxQueuedFrames = 1;
+};
+
+struct PacingStats {
+    // start to start of the last frame, and its mean and standard deviation over the window
+    double frameMs = 0.0;
+    double meanMs = 0.0;
+    double deviationMs = 0.0;
+    // from sampling input to the GPU finishing the frame that used it, the latest measured
+    // frames that weren't waited for are only seen finished at the next endFrame(), so this is an upper bound
+    double inputLatencyMs = 0.0;
+    // where the last frame waited
+    double sleepMs = 0.0;
+    double spinMs = 0.0;
+    double queueWaitMs = 0.0;
+};
+
+// owns the frame loop's timing: vsync, the frame limiter, when input is polled and how far the GPU can fall behind
+// the limiter sleeps until shortly before the deadline and spins the rest, sleeping alone overshoots by up to a millisecond
+// frame time, deviation and latency go to the profiler as counters
+// beginFrame() polls GLFW so it belongs to the main thread, endFrame() to whichever thread has the GL context,
+// settings only change between frames, when neither is running
+class FramePacer {
+public:
+    // with no window, for an offscreen context, there is nothing to poll or swap and vsync does nothing
+    FramePacer(GLFWwindow* window, PacingSettings settings);
+    ~FramePacer();
+    FramePacer(const FramePacer&) = delete;
+    FramePacer& operator=(const FramePacer&) = delete;
+
+    void setSettings(PacingSettings settings);
+    inline const PacingSettings& settings() const {
+        return current;
+    }
+    // waits until the frame is due, then polls input so the simulation sees the newest state
+    // returns the seconds since the last frame started
+    double beginFrame();
+    // when this frame's input was polled, for endFrame()
+    inline uint64_t inputSampled() const {
+        return inputTime;
+    }
+    // swaps, then waits until no more than maxQueuedFrames are left in flight
+    // inputTime is inputSampled() of the frame being ended, it may already belong to the next frame
+    void endFrame(uint64_t inputTime);
+    inline const PacingStats& stats() const {
+        return lastStats;
+    }
+private:
+    struct InFlight {
+        GLsync fence;
+        uint64_t inputTime;
+    };
+    // true once the frame's fence signalled, waiting up to timeout nanoseconds for it
+    bool finish(const InFlight& frame, uint64_t timeout);
+
+    GLFWwindow* window;
+    PacingSettings current;
+    // the swap interval is set from endFrame(), where the context is current
+    bool swapIntervalChanged = true;
+    uint64_t deadline = 0;
+    uint64_t frameStart = 0;
+    uint64_t inputTime = 0;
+    std::deque<InFlight> inFlight;
+    std::array<double, PACING_WINDOW_FRAMES> frameTimes = {};
+    int nextFrameTime = 0;
+    int frameTimeCount = 0;
+    PacingStats lastStats;
+};
+
+#endif
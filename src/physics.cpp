@@ -3,7 +3,7 @@
 
 Shadow::Shadow() : min(0), max(0) {}
 Shadow::Shadow(float min, float max) : min(min), max(max) {}
-Shadow::Shadow(const std::vector<float>& points) : min(std::numeric_limits<float>::max()), max(std::numeric_limits<float>::lowest()) {
+Shadow::Shadow(std::span<const float> points) : min(std::numeric_limits<float>::max()), max(std::numeric_limits<float>::lowest()) {
     for (float pt : points) {
         min = std::min(min, pt);
         max = std::max(max, pt);
@@ -16,7 +16,7 @@ bool intersect(const Shadow& a, const Shadow& b) {
             b.min <= a.max && a.max <= b.max;
 }
 
-float absMin(const std::vector<float>& args) {
+float absMin(std::span<const float> args) {
     assert(!args.empty());
     float absMin = args[0];
     for(int i = 1; i < args.size(); ++i) {
@@ -27,7 +27,7 @@ float absMin(const std::vector<float>& args) {
     return absMin;
 }
 
-glm::vec2 absMin(const std::vector<glm::vec2>& args) {
+glm::vec2 absMin(std::span<const glm::vec2> args) {
     assert(!args.empty());
     glm::vec2 absMin = args[0];
     for(int i = 1; i < args.size(); ++i) {
@@ -40,23 +40,26 @@ glm::vec2 absMin(const std::vector<glm::vec2>& args) {
 
 float resolveIntersect(Shadow pusher, Shadow mover) {
     if(!intersect(pusher, mover)) return 0;
-    return absMin({pusher.max - mover.min, -(mover.max - pusher.min)});
+    float options[] = {pusher.max - mover.min, -(mover.max - pusher.min)};
+    return absMin(options);
 }
 
-std::vector<float> resolveOptions(const Shadow& pusher, Shadow& mover) {
-    if(!intersect(pusher, mover)) return {};
-    return {pusher.max - mover.min + 0.005f, -(mover.max - pusher.min + 0.005f)};
+ScratchVector<float> resolveOptions(const Shadow& pusher, Shadow& mover) {
+    ScratchVector<float> options = scratchVector<float>();
+    if(!intersect(pusher, mover)) return options;
+    options.assign({pusher.max - mover.min + 0.005f, -(mover.max - pusher.min + 0.005f)});
+    return options;
 }
 
-std::vector<glm::vec2> groupMul(const glm::vec2& v, const std::vector<float>& f) {
-    std::vector<glm::vec2> array(f.size(), glm::vec2(0.0f));
+ScratchVector<glm::vec2> groupMul(const glm::vec2& v, std::span<const float> f) {
+    ScratchVector<glm::vec2> array(f.size(), glm::vec2(0.0f), &frameScratch());
     for(int i = 0; i < f.size(); ++i) {
         array[i] = glm::vec2(v.x * f[i], v.y * f[i]);
     }
     return array;
 }
 
-float min(const std::vector<float>& points) {
+float min(std::span<const float> points) {
     assert(!points.empty());
     float min = points[0];
     for(int i = 1; i < points.size(); ++i) {
@@ -67,7 +70,7 @@ float min(const std::vector<float>& points) {
     return min;
 }
 
-float max(const std::vector<float>& points) {
+float max(std::span<const float> points) {
     assert(!points.empty());
     float max = points[0];
     for(int i = 1; i < points.size(); ++i) {
@@ -78,9 +81,9 @@ float max(const std::vector<float>& points) {
     return max;
 }
 
-std::vector<float> project(const glm::vec2& v, const std::vector<glm::vec2>& points) {
+ScratchVector<float> project(const glm::vec2& v, std::span<const glm::vec2> points) {
     glm::vec2 u = glm::vec2(v.x / v.length(), v.y / v.length());
-    std::vector<float> f(points.size(), 0.0f);
+    ScratchVector<float> f(points.size(), 0.0f, &frameScratch());
     for(int i = 0; i < points.size(); ++i) {
         f[i] = u.x * points[i].x + u.y * points[i].y;
     }
@@ -88,13 +91,13 @@ std::vector<float> project(const glm::vec2& v, const std::vector<glm::vec2>& poi
 }
 
 
-std::vector<glm::vec2> Box::points() const {
-    return {
+ScratchVector<glm::vec2> Box::points() const {
+    return ScratchVector<glm::vec2>({
         {position.x - (scale.x / 2.0f), position.y - (scale.y / 2.0f)},
         {position.x - (scale.x / 2.0f), position.y + (scale.y / 2.0f)},
         {position.x + (scale.x / 2.0f), position.y + (scale.y / 2.0f)},
         {position.x + (scale.x / 2.0f), position.y - (scale.y / 2.0f)},
-    };
+    }, &frameScratch());
 }
 
 Shadow shadow(const Convex& convex, const glm::vec2& span) {
@@ -109,19 +112,20 @@ bool intersect(const Convex& a, const Convex& b) {
             shadow(b, glm::vec2(0, 1)));
 }
 
-std::vector<glm::vec2> resolveOptions(const Convex& pusher, const Convex& mover) {
-    std::vector<glm::vec2> options;
-    std::vector<glm::vec2> basis = {
+ScratchVector<glm::vec2> resolveOptions(const Convex& pusher, const Convex& mover) {
+    ScratchVector<glm::vec2> options = scratchVector<glm::vec2>();
+    const glm::vec2 basis[] = {
         {1, 0},
         {0, 1}
     };
-    for(glm::vec2& v : basis) {
+    for(const glm::vec2& v : basis) {
         Shadow a = shadow(pusher, v);
         Shadow b = shadow(mover, v);
         if(!intersect(a, b)) {
-            return {};
+            options.clear();
+            return options;
         }
-        std::vector<glm::vec2> groupMulRes = groupMul(v, resolveOptions(a, b));
+        ScratchVector<glm::vec2> groupMulRes = groupMul(v, resolveOptions(a, b));
         options.insert(options.end(), groupMulRes.begin(), groupMulRes.end());
     }
     return options;
@@ -150,7 +154,7 @@ glm::vec2 resolveY(const Convex& pusher, const Convex& mover) {
 }
 
 Box getBoundingBox(const Convex& convex) {
-    std::vector<glm::vec2> points = convex.points();
+    ScratchVector<glm::vec2> points = convex.points();
     glm::vec2 min = {std::numeric_limits<float>::max(), std::numeric_limits<float>::max()};
     glm::vec2 max = {std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest()};
     for (const glm::vec2 & pt : points) {
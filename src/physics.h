@@ -6,17 +6,19 @@
 #include <vector>
 #include <glm/glm.hpp>
 #include <glm/gtx/norm.hpp>
+#include <span>
+#include "scratch.h"
 
 class Convex {
 public:
-    virtual std::vector<glm::vec2> points() const = 0;
+    virtual ScratchVector<glm::vec2> points() const = 0;
 };
 
 class Box : public Convex {
 public:
     glm::vec2 position;
     glm::vec2 scale;
-    virtual std::vector<glm::vec2> points() const;
+    virtual ScratchVector<glm::vec2> points() const;
     inline virtual ~Box() {}
     inline Box() {}
     inline Box(const glm::vec2& position, const glm::vec2& scale) : position(position), scale(scale) {}
@@ -27,21 +29,22 @@ public:
     float min, max;
     Shadow();
     Shadow(float min, float max);
-    Shadow(const std::vector<float>& points);
+    Shadow(std::span<const float> points);
 };
 
-float absMin(const std::vector<float>& args);
-glm::vec2 absMin(const std::vector<glm::vec2>& args);
+// everything returning a vector here allocates it from frameScratch()
+float absMin(std::span<const float> args);
+glm::vec2 absMin(std::span<const glm::vec2> args);
 float resolveIntersect(Shadow pusher, Shadow mover);
-std::vector<float> resolveOptions(const Shadow& pusher, Shadow& mover);
-std::vector<glm::vec2> groupMul(const glm::vec2& v, const std::vector<float>& f);
-float min(const std::vector<float>& points);
-float max(const std::vector<float>& points);
-std::vector<float> project(const glm::vec2& v, const std::vector<glm::vec2>& points);
+ScratchVector<float> resolveOptions(const Shadow& pusher, Shadow& mover);
+ScratchVector<glm::vec2> groupMul(const glm::vec2& v, std::span<const float> f);
+float min(std::span<const float> points);
+float max(std::span<const float> points);
+ScratchVector<float> project(const glm::vec2& v, std::span<const glm::vec2> points);
 bool intersect(const Shadow& a, const Shadow& b); 
 Shadow shadow(const Convex& convex, const glm::vec2& span);
 bool intersect(const Convex& a, const Convex& b);
-std::vector<glm::vec2> resolveOptions(Box pusher, Box mover);
+ScratchVector<glm::vec2> resolveOptions(const Convex& pusher, const Convex& mover);
 glm::vec2 resolve(const Convex& pusher, const Convex& mover);
 glm::vec2 resolveX(const Convex& pusher, const Convex& mover);
 glm::vec2 resolveY(const Convex& pusher, const Convex& mover);
@@ -0,0 +1,121 @@
+#ifndef SRC_POOL_H_INCLUDED
+#define SRC_POOL_H_INCLUDED
+#include <cstddef>
+#include <cassert>
+#include <new>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// free list of fixed size slots for T, grown a slab at a time and never shrunk
+// released slots are reused before a new slab is allocated
+template <typename T, size_t SLAB_SIZE = 64>
+class Pool {
+public:
+    Pool() = default;
+    Pool(const Pool&) = delete;
+    Pool& operator=(const Pool&) = delete;
+
+    inline void* allocate() {
+        if (freeList == nullptr) {
+            grow();
+        }
+        Slot* slot = freeList;
+        freeList = slot->next;
+        ++live;
+        return slot;
+    }
+    inline void release(void* ptr) {
+        Slot* slot = static_cast<Slot*>(ptr);
+        slot->next = freeList;
+        freeList = slot;
+        --live;
+    }
+    inline size_t liveCount() const { return live; }
+    inline size_t capacity() const { return slabs.size() * SLAB_SIZE; }
+    inline size_t slabCount() const { return slabs.size(); }
+private:
+    union Slot {
+        Slot* next;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+    void grow() {
+        slabs.push_back(std::unique_ptr<Slot[]>(new Slot[SLAB_SIZE]));
+        Slot* slab = slabs.back().get();
+        for (size_t i = 0; i < SLAB_SIZE; ++i) {
+            slab[i].next = freeList;
+            freeList = &slab[i];
+        }
+    }
+    std::vector<std::unique_ptr<Slot[]>> slabs;
+    Slot* freeList = nullptr;
+    size_t live = 0;
+};
+
+// inherit from Pooled<T> to make "new T" and "delete t" go through a Pool<T>
+// subclasses of T are a different size, so they fall back to the global heap
+template <typename T>
+class Pooled {
+public:
+    static void* operator new(size_t size) {
+        if (size != sizeof(T)) {
+            return ::operator new(size);
+        }
+        return pool().allocate();
+    }
+    static void operator delete(void* ptr, size_t size) {
+        if (size != sizeof(T)) {
+            ::operator delete(ptr);
+            return;
+        }
+        pool().release(ptr);
+    }
+    // the class operator new hides placement new, so bring it back for ObjectArena
+    static void* operator new(size_t size, void* place) {
+        return place;
+    }
+    static void operator delete(void* ptr, void* place) {}
+
+    static Pool<T>& pool() {
+        static Pool<T> instance;
+        return instance;
+    }
+};
+
+// fixed capacity storage for objects that all die together
+// clear() runs the destructors but keeps the memory, so refilling it doesn't allocate
+template <typename T>
+class ObjectArena {
+public:
+    explicit ObjectArena(size_t capacity) : capacity(capacity), count(0) {
+        storage = static_cast<T*>(::operator new(capacity * sizeof(T), std::align_val_t(alignof(T))));
+    }
+    ~ObjectArena() {
+        clear();
+        ::operator delete(storage, std::align_val_t(alignof(T)));
+    }
+    ObjectArena(const ObjectArena&) = delete;
+    ObjectArena& operator=(const ObjectArena&) = delete;
+
+    template <typename... Args>
+    T* emplace(Args&&... args) {
+        assert(count < capacity);
+        T* obj = new (storage + count) T(std::forward<Args>(args)...);
+        ++count;
+        return obj;
+    }
+    void clear() {
+        while (count > 0) {
+            --count;
+            storage[count].~T();
+        }
+    }
+    inline size_t size() const { return count; }
+    inline T& operator[](size_t index) { return storage[index]; }
+private:
+    T* storage;
+    size_t capacity;
+    size_t count;
+};
+
+#endif
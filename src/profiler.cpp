@@ -0,0 +1,198 @@
+#include "profiler.h"
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// per thread, about 2.5 MB each and only allocated once a thread records something
+const size_t PROFILE_RING_EVENTS = 1 << 16;
+// frames to wait after a capture for the last GPU timers
+const int PROFILE_DRAIN_FRAMES = 3;
+
+std::atomic<bool> profilerActive = false;
+
+namespace {
+
+struct ProfileEvent {
+    const char* name;
+    uint64_t start;
+    uint64_t end;
+    // counters are a value at start
+    bool counter;
+    double value;
+};
+
+// a single writer appends and the trace writer reads behind it, older events are overwritten
+struct Track {
+    std::string name;
+    std::unique_ptr<ProfileEvent[]> events = std::make_unique<ProfileEvent[]>(PROFILE_RING_EVENTS);
+    std::atomic<uint64_t> head = 0;
+};
+
+struct Capture {
+    std::mutex mutex;
+    // tracks are never freed, a thread may exit while the trace is being written
+    std::vector<std::unique_ptr<Track>> tracks;
+    std::string path;
+    int requestedFrames = 0;
+    int framesLeft = 0;
+    int drainFramesLeft = 0;
+    int frames = 0;
+    uint64_t start = 0;
+    uint64_t end = 0;
+    uint64_t frameStart = 0;
+};
+
+Capture& capture() {
+    static Capture capture;
+    return capture;
+}
+
+// returns the track's id
+int addTrack(const std::string& name) {
+    Capture& c = capture();
+    std::lock_guard<std::mutex> lock(c.mutex);
+    c.tracks.push_back(std::make_unique<Track>());
+    c.tracks.back()->name = name.empty() ? "thread " + std::to_string(c.tracks.size()) : name;
+    return (int) c.tracks.size() - 1;
+}
+
+Track* track(int id) {
+    Capture& c = capture();
+    std::lock_guard<std::mutex> lock(c.mutex);
+    return c.tracks[id].get();
+}
+
+thread_local Track* threadTrack = nullptr;
+thread_local const char* threadName = nullptr;
+
+Track* currentThreadTrack() {
+    if (!threadTrack) {
+        threadTrack = track(addTrack(threadName ? threadName : ""));
+    }
+    return threadTrack;
+}
+
+void record(Track* track, const ProfileEvent& event) {
+    uint64_t head = track->head.load(std::memory_order_relaxed);
+    track->events[head & (PROFILE_RING_EVENTS - 1)] = event;
+    track->head.store(head + 1, std::memory_order_release);
+}
+
+void writeString(std::ostream& out, const char* s) {
+    out << '"';
+    for (; *s; ++s) {
+        if (*s == '"' || *s == '\\') {
+            out << '\\';
+        }
+        out << *s;
+    }
+    out << '"';
+}
+
+// Chrome trace event format, complete events with microsecond times relative to the capture start
+void writeTrace(Capture& c) {
+    std::ofstream out(c.path);
+    if (!out) {
+        std::cerr << "Profile: could not write " << c.path << std::endl;
+        return;
+    }
+    std::lock_guard<std::mutex> lock(c.mutex);
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    size_t written = 0;
+    for (size_t tid = 0; tid < c.tracks.size(); ++tid) {
+        const Track& track = *c.tracks[tid];
+        out << (tid == 0 ? "" : ",\n") << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << tid << ",\"args\":{\"name\":";
+        writeString(out, track.name.c_str());
+        out << "}}";
+        uint64_t head = track.head.load(std::memory_order_acquire);
+        uint64_t first = head > PROFILE_RING_EVENTS ? head - PROFILE_RING_EVENTS : 0;
+        for (uint64_t i = first; i < head; ++i) {
+            const ProfileEvent& event = track.events[i & (PROFILE_RING_EVENTS - 1)];
+            if (event.start < c.start || event.end > c.end) {
+                continue;
+            }
+            out << ",\n{\"ph\":\"" << (event.counter ? "C" : "X") << "\",\"pid\":1,\"tid\":" << tid << ",\"name\":";
+            writeString(out, event.name);
+            out << ",\"ts\":" << (event.start - c.start) / 1000.0;
+            if (event.counter) {
+                out << ",\"args\":{\"value\":" << event.value << "}}";
+            } else {
+                out << ",\"dur\":" << (event.end - event.start) / 1000.0 << "}";
+            }
+            ++written;
+        }
+    }
+    out << "\n]}\n";
+    std::cout << "Profile: " << written << " events over " << c.frames << " frames written to " << c.path << std::endl;
+}
+
+}
+
+uint64_t profileNow() {
+    return (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void recordZone(const char* name, uint64_t start, uint64_t end) {
+    record(currentThreadTrack(), {name, start, end, false, 0.0});
+}
+
+int profileTrack(const char* name) {
+    return addTrack(name);
+}
+
+void recordZone(int id, const char* name, uint64_t start, uint64_t end) {
+    record(track(id), {name, start, end, false, 0.0});
+}
+
+void recordCounter(const char* name, uint64_t time, double value) {
+    record(currentThreadTrack(), {name, time, time, true, value});
+}
+
+void nameProfileThread(const char* name) {
+    threadName = name;
+    if (threadTrack) {
+        Capture& c = capture();
+        std::lock_guard<std::mutex> lock(c.mutex);
+        threadTrack->name = name;
+    }
+}
+
+void startProfileCapture(int frames, const std::string& path) {
+    Capture& c = capture();
+    if (c.framesLeft > 0 || c.drainFramesLeft > 0) {
+        return;
+    }
+    c.path = path;
+    c.requestedFrames = frames;
+}
+
+void profileFrame() {
+    Capture& c = capture();
+    uint64_t now = profileNow();
+    if (c.framesLeft > 0) {
+        recordZone("frame", c.frameStart, now);
+        c.frameStart = now;
+        ++c.frames;
+        if (--c.framesLeft == 0) {
+            profilerActive.store(false, std::memory_order_relaxed);
+            c.end = now;
+            c.drainFramesLeft = PROFILE_DRAIN_FRAMES;
+        }
+    } else if (c.drainFramesLeft > 0) {
+        if (--c.drainFramesLeft == 0) {
+            writeTrace(c);
+        }
+    } else if (c.requestedFrames > 0) {
+        c.framesLeft = c.requestedFrames;
+        c.requestedFrames = 0;
+        c.frames = 0;
+        c.start = now;
+        c.frameStart = now;
+        profilerActive.store(true, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef SRC_PROFILER_H_INCLUDED
+#define SRC_PROFILER_H_INCLUDED
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// nanoseconds on the steady clock, what every zone is timed with
+uint64_t profileNow();
+
+// zones are only recorded while a capture runs, outside of one a zone costs a relaxed load
+extern std::atomic<bool> profilerActive;
+inline bool profiling() {
+    return profilerActive.load(std::memory_order_relaxed);
+}
+
+// names are kept as pointers until the trace is written, so they should be string literals
+// records on the calling thread's track, every thread has its own ring buffer
+void recordZone(const char* name, uint64_t start, uint64_t end);
+// tracks that aren't a thread, like GPU timers, each must only be written from one thread
+int profileTrack(const char* name);
+void recordZone(int track, const char* name, uint64_t start, uint64_t end);
+// a value over time, drawn as a graph in the trace
+void recordCounter(const char* name, uint64_t time, double value);
+// how this thread's track is labelled in the trace
+void nameProfileThread(const char* name);
+
+// times its scope, use PROFILE_ZONE
+class ProfileZone {
+public:
+    inline explicit ProfileZone(const char* name) : name(profiling() ? name : nullptr) {
+        if (this->name) {
+            start = profileNow();
+        }
+    }
+    inline ~ProfileZone() {
+        if (name) {
+            recordZone(name, start, profileNow());
+        }
+    }
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+private:
+    const char* name;
+    uint64_t start = 0;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+
+// captures the next frames into a Chrome trace JSON file, open it in chrome://tracing or ui.perfetto.dev
+void startProfileCapture(int frames, const std::string& path);
+// call once at the end of every frame on the main thread
+// the trace is written a few frames after the last captured one so GPU timers can come back
+void profileFrame();
+
+#endif
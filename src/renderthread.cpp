@@ -0,0 +1,89 @@
+#include "renderthread.h"
+#include "profiler.h"
+#include "graphics/headless.h"
+#include <utility>
+
+RenderThread::RenderThread(GLFWwindow* window) : window(window) {
+    // a context can only be current on one thread
+    makeCurrent(false);
+    thread = std::thread(&RenderThread::run, this);
+}
+
+RenderThread::RenderThread(HeadlessContext* headless) : headless(headless) {
+    makeCurrent(false);
+    thread = std::thread(&RenderThread::run, this);
+}
+
+RenderThread::~RenderThread() {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [this]() { return !busy; });
+        stopping = true;
+    }
+    started.notify_one();
+    thread.join();
+    makeCurrent(true);
+}
+
+void RenderThread::submit(std::function<void()> frame) {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [this]() { return !busy; });
+        if (error) {
+            std::rethrow_exception(std::exchange(error, nullptr));
+        }
+        this->frame = std::move(frame);
+        busy = true;
+    }
+    started.notify_one();
+}
+
+void RenderThread::wait() {
+    PROFILE_ZONE("render wait");
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [this]() { return !busy; });
+    if (error) {
+        std::rethrow_exception(std::exchange(error, nullptr));
+    }
+}
+
+void RenderThread::run() {
+    nameProfileThread("render");
+    makeCurrent(true);
+    while (true) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            started.wait(lock, [this]() { return stopping || busy; });
+            if (stopping) {
+                break;
+            }
+            job = std::move(frame);
+        }
+        std::exception_ptr thrown;
+        try {
+            job();
+        } catch (...) {
+            thrown = std::current_exception();
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            error = thrown;
+            busy = false;
+        }
+        finished.notify_all();
+    }
+    makeCurrent(false);
+}
+
+void RenderThread::makeCurrent(bool current) {
+    if (headless) {
+        if (current) {
+            headless->makeCurrent();
+        } else {
+            headless->releaseCurrent();
+        }
+        return;
+    }
+    glfwMakeContextCurrent(current ? window : nullptr);
+}
@@ -0,0 +1,49 @@
+#ifndef SRC_RENDERTHREAD_H_INCLUDED
+#define SRC_RENDERTHREAD_H_INCLUDED
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+class HeadlessContext;
+
+// owns the window's GL context on its own thread and runs one frame of recorded work at a time
+// the main thread records the next frame while the last one is being drawn, submit() waits for the last one first,
+// so there is never more than one frame in flight
+class RenderThread {
+public:
+    // takes the context away from the calling thread, everything GL has to be created before this
+    explicit RenderThread(GLFWwindow* window);
+    // the same for an offscreen context, frames are drawn into its framebuffer
+    explicit RenderThread(HeadlessContext* headless);
+    // waits for the frame in flight, then gives the context back to the calling thread so GL objects can be destroyed
+    ~RenderThread();
+    RenderThread(const RenderThread&) = delete;
+    RenderThread& operator=(const RenderThread&) = delete;
+
+    // waits for the frame in flight, then starts frame without waiting for it
+    // rethrows whatever the last frame threw
+    void submit(std::function<void()> frame);
+    // waits until the frame in flight is done, everything it wrote can be read after this
+    void wait();
+private:
+    void run();
+    // moves whichever context this was made with onto or off the calling thread
+    void makeCurrent(bool current);
+
+    GLFWwindow* window = nullptr;
+    HeadlessContext* headless = nullptr;
+    std::mutex mutex;
+    std::condition_variable started;
+    std::condition_variable finished;
+    std::function<void()> frame;
+    bool busy = false;
+    bool stopping = false;
+    std::exception_ptr error;
+    std::thread thread;
+};
+
+#endif
@@ -0,0 +1,60 @@
+#include "scratch.h"
+#include <new>
+#include <algorithm>
+#include <cstdint>
+
+const size_t FRAME_SCRATCH_SIZE = 1 << 20;
+
+ScratchArena::ScratchArena(size_t capacity) : size(capacity) {
+    buffer = static_cast<char*>(::operator new(size));
+    overflowBlocks.reserve(16);
+}
+
+ScratchArena::~ScratchArena() {
+    reset();
+    ::operator delete(buffer);
+}
+
+void ScratchArena::reset() {
+    if (!overflowBlocks.empty()) {
+        for (auto& block : overflowBlocks) {
+            ::operator delete(block.first, std::align_val_t(block.second));
+        }
+        overflowBlocks.clear();
+        // grow so that this frame's worth of temporaries fits next time
+        size_t wanted = offset + overflow;
+        while (size < wanted) {
+            size *= 2;
+        }
+        ::operator delete(buffer);
+        buffer = static_cast<char*>(::operator new(size));
+    }
+    offset = 0;
+    overflow = 0;
+}
+
+void* ScratchArena::do_allocate(size_t bytes, size_t alignment) {
+    uintptr_t base = reinterpret_cast<uintptr_t>(buffer);
+    size_t start = ((base + offset + alignment - 1) & ~(alignment - 1)) - base;
+    if (start + bytes <= size) {
+        offset = start + bytes;
+        peak = std::max(peak, offset);
+        return buffer + start;
+    }
+    overflow += bytes + alignment;
+    void* block = ::operator new(bytes, std::align_val_t(alignment));
+    overflowBlocks.push_back({block, alignment});
+    return block;
+}
+
+void ScratchArena::do_deallocate(void* ptr, size_t bytes, size_t alignment) {
+}
+
+bool ScratchArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+ScratchArena& frameScratch() {
+    thread_local ScratchArena arena(FRAME_SCRATCH_SIZE);
+    return arena;
+}
@@ -0,0 +1,48 @@
+#ifndef SRC_SCRATCH_H_INCLUDED
+#define SRC_SCRATCH_H_INCLUDED
+#include <memory_resource>
+#include <vector>
+#include <cstddef>
+
+// bump allocator for temporaries that only live until the end of the frame
+// deallocate does nothing, reset() throws everything away at once
+class ScratchArena : public std::pmr::memory_resource {
+public:
+    explicit ScratchArena(size_t capacity);
+    ~ScratchArena();
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+
+    // O(1) unless the arena overflowed since the last reset, in which case the
+    // overflow blocks are freed and the buffer grows so the next frame fits
+    void reset();
+    inline size_t used() const { return offset; }
+    inline size_t capacity() const { return size; }
+    // bytes that didn't fit and had to come from the heap since the last reset
+    inline size_t overflowBytes() const { return overflow; }
+    inline size_t highWater() const { return peak; }
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    char* buffer;
+    size_t size;
+    size_t offset = 0;
+    size_t overflow = 0;
+    size_t peak = 0;
+    std::vector<std::pair<void*, size_t>> overflowBlocks;
+};
+
+// the calling thread's frame arena, reset by the main loop once per frame
+ScratchArena& frameScratch();
+
+template <typename T>
+using ScratchVector = std::pmr::vector<T>;
+
+template <typename T>
+inline ScratchVector<T> scratchVector() {
+    return ScratchVector<T>(&frameScratch());
+}
+
+#endif
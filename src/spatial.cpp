@@ -0,0 +1,110 @@
+#include "spatial.h"
+#include "util.h"
+#include <algorithm>
+#include <cmath>
+
+SpatialIndex::SpatialIndex(float cellSize) : cellSize(cellSize) {}
+
+SpatialIndex::CellRange SpatialIndex::cellRange(const Bounds& bounds) const {
+    return {
+        (int) std::floor(bounds.min.x / cellSize), (int) std::floor(bounds.min.y / cellSize),
+        (int) std::floor(bounds.max.x / cellSize), (int) std::floor(bounds.max.y / cellSize)
+    };
+}
+
+uint64_t SpatialIndex::cellKey(int x, int y) {
+    return ((uint64_t) (uint32_t) x << 32) | (uint32_t) y;
+}
+
+void SpatialIndex::link(Entity entity, const CellRange& range) {
+    for (int y = range.minY; y <= range.maxY; ++y) {
+        for (int x = range.minX; x <= range.maxX; ++x) {
+            cells[cellKey(x, y)].push_back(entity);
+        }
+    }
+}
+
+void SpatialIndex::unlink(Entity entity, const CellRange& range) {
+    for (int y = range.minY; y <= range.maxY; ++y) {
+        for (int x = range.minX; x <= range.maxX; ++x) {
+            // empty lists are kept so their memory is reused when something moves back in
+            std::vector<Entity>& cell = cells[cellKey(x, y)];
+            auto p = std::find(cell.begin(), cell.end(), entity);
+            if (p != cell.end()) {
+                *p = cell.back();
+                cell.pop_back();
+            }
+        }
+    }
+}
+
+void SpatialIndex::update(Entity entity, const Bounds& bounds) {
+    if (entity >= entries.size()) {
+        entries.resize(entity + 1);
+    }
+    Entry& entry = entries[entity];
+    CellRange range = cellRange(bounds);
+    if (!entry.present) {
+        link(entity, range);
+        entry.present = true;
+        ++count;
+    } else if (!(entry.cells == range)) {
+        unlink(entity, entry.cells);
+        link(entity, range);
+    }
+    entry.cells = range;
+    entry.bounds = bounds;
+}
+
+void SpatialIndex::remove(Entity entity) {
+    if (entity >= entries.size() || !entries[entity].present) {
+        return;
+    }
+    unlink(entity, entries[entity].cells);
+    entries[entity].present = false;
+    --count;
+}
+
+void SpatialIndex::query(const Bounds& bounds, ScratchVector<Entity>& out) const {
+    CellRange range = cellRange(bounds);
+    size_t start = out.size();
+    auto collect = [this, &bounds, &out](const std::vector<Entity>& cell) {
+        for (Entity entity : cell) {
+            if (entries[entity].bounds.overlaps(bounds)) {
+                out.push_back(entity);
+            }
+        }
+    };
+    // zoomed far out there are fewer occupied cells than cells in range
+    double rangeCells = ((double) range.maxX - range.minX + 1) * ((double) range.maxY - range.minY + 1);
+    if (rangeCells > (double) cells.size()) {
+        for (const auto& p : cells) {
+            collect(p.second);
+        }
+    } else {
+        for (int y = range.minY; y <= range.maxY; ++y) {
+            for (int x = range.minX; x <= range.maxX; ++x) {
+                auto p = cells.find(cellKey(x, y));
+                if (p != cells.end()) {
+                    collect(p->second);
+                }
+            }
+        }
+    }
+    // entities spanning several cells were found once per cell
+    std::sort(out.begin() + start, out.end());
+    out.erase(std::unique(out.begin() + start, out.end()), out.end());
+}
+
+void updateSpriteBounds(const ComponentStore& components, SpatialIndex& index) {
+    size_t count = components.size();
+    for (size_t i = 0; i < count; ++i) {
+        const Sprite& sprite = components.sprites[i];
+        if (sprite.sheet == SPRITE_NONE) {
+            continue;
+        }
+        glm::vec2 center = components.transforms[i].position + sprite.offset;
+        glm::vec2 half = glm::abs(sprite.scale) * 0.5f;
+        index.update(components.entities[i], {center - half, center + half});
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef SRC_SPATIAL_H_INCLUDED
+#define SRC_SPATIAL_H_INCLUDED
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+#include "components.h"
+#include "scratch.h"
+
+// axis aligned bounds in world units
+struct Bounds {
+    glm::vec2 min;
+    glm::vec2 max;
+    inline bool overlaps(const Bounds& other) const {
+        return min.x <= other.max.x && other.min.x <= max.x && min.y <= other.max.y && other.min.y <= max.y;
+    }
+};
+
+// a uniform grid over the world, each entity is listed in every cell its bounds touch
+// update() only edits the cell lists when an entity crosses into a different range of cells,
+// so objects that stay put cost one comparison
+class SpatialIndex {
+public:
+    explicit SpatialIndex(float cellSize);
+    void update(Entity entity, const Bounds& bounds);
+    void remove(Entity entity);
+    // every entity overlapping the bounds, once each, in ascending order
+    void query(const Bounds& bounds, ScratchVector<Entity>& out) const;
+    inline size_t size() const {
+        return count;
+    }
+private:
+    struct CellRange {
+        int minX, minY, maxX, maxY;
+        inline bool operator==(const CellRange& other) const = default;
+    };
+    struct Entry {
+        bool present = false;
+        CellRange cells;
+        Bounds bounds;
+    };
+    CellRange cellRange(const Bounds& bounds) const;
+    static uint64_t cellKey(int x, int y);
+    void link(Entity entity, const CellRange& range);
+    void unlink(Entity entity, const CellRange& range);
+
+    float cellSize;
+    size_t count = 0;
+    std::unordered_map<uint64_t, std::vector<Entity>> cells;
+    std::vector<Entry> entries;
+};
+
+// system: keeps the index in step with where every sprite is drawn
+void updateSpriteBounds(const ComponentStore& components, SpatialIndex& index);
+
+#endif
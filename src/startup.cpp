@@ -0,0 +1,29 @@
+#include "startup.h"
+#include <iomanip>
+
+static double msBetween(std::chrono::steady_clock::time_point a, std::chrono::steady_clock::time_point b) {
+    return std::chrono::duration<double, std::milli>(b - a).count();
+}
+
+StartupTimer::StartupTimer() : start(std::chrono::steady_clock::now()), last(start) {}
+
+void StartupTimer::mark(const std::string& phase) {
+    mark(phase, std::chrono::steady_clock::now());
+}
+
+void StartupTimer::mark(const std::string& phase, std::chrono::steady_clock::time_point end) {
+    phases.push_back({phase, msBetween(last, end)});
+    last = end;
+}
+
+double StartupTimer::totalMs() const {
+    return msBetween(start, last);
+}
+
+void StartupTimer::print(std::ostream& out) const {
+    out << "Startup: " << std::fixed << std::setprecision(1) << totalMs() << " ms\n";
+    for (const auto& phase : phases) {
+        out << "  " << std::left << std::setw(16) << phase.first << std::right << std::setw(8) << phase.second << " ms\n";
+    }
+    out << std::defaultfloat << std::flush;
+}
@@ -0,0 +1,24 @@
+#ifndef SRC_STARTUP_H_INCLUDED
+#define SRC_STARTUP_H_INCLUDED
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// wall clock time of each startup phase, measured from construction
+class StartupTimer {
+public:
+    StartupTimer();
+    // ends the phase that is running now under the given name and starts the next one
+    void mark(const std::string& phase);
+    // the same, for a phase that ended at a time measured elsewhere
+    void mark(const std::string& phase, std::chrono::steady_clock::time_point end);
+    double totalMs() const;
+    void print(std::ostream& out) const;
+private:
+    std::chrono::steady_clock::time_point start;
+    std::chrono::steady_clock::time_point last;
+    std::vector<std::pair<std::string, double>> phases;
+};
+
+#endif
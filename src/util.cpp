@@ -17,6 +17,15 @@ std::string readFile(const std::string_view& file) {
     return output;
 }
 
+uint64_t hashBytes(uint64_t hash, std::string_view bytes) {
+    for (char c : bytes) {
+        hash ^= (unsigned char) c;
+        hash *= 0x100000001b3ull;
+    }
+    // separator so ("ab", "c") and ("a", "bc") differ
+    return (hash ^ 0xff) * 0x100000001b3ull;
+}
+
 std::vector<unsigned char> readImage(const std::string_view& fileName, int& width, int& height) {
 //    png::image<png::rgba_pixel> image(file.data());
 //    width = image.get_width();
@@ -5,9 +5,14 @@
 #include <string>
 #include <fstream>
 #include <cassert>
+#include <cstdint>
+#include <string_view>
 
 std::string readFile(const std::string_view& file);
 std::vector<unsigned char> readImage(const std::string_view& file, int& width, int& height);
+// FNV-1a, start from FNV_OFFSET and feed it one field at a time
+const uint64_t FNV_OFFSET = 0xcbf29ce484222325ull;
+uint64_t hashBytes(uint64_t hash, std::string_view bytes);
 int divRoundDown(int a, int b);
 int modRoundDown(int a, int b);
 inline int floorInt(float num) {
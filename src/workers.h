@@ -0,0 +1,46 @@
+#ifndef SRC_WORKERS_H_INCLUDED
+#define SRC_WORKERS_H_INCLUDED
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// a fixed set of threads running queued jobs in the order they were submitted
+// jobs must not touch GL, while the game runs the context belongs to the RenderThread
+class WorkerPool {
+public:
+    // 0 means one thread per core, leaving one for the main thread
+    explicit WorkerPool(int threads = 0);
+    // runs whatever is still queued, then joins
+    ~WorkerPool();
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // exceptions thrown by the job come out of the future's get()
+    template <typename F>
+    auto submit(F job) -> std::future<decltype(job())> {
+        using Result = decltype(job());
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::move(job));
+        std::future<Result> result = task->get_future();
+        push([task]() { (*task)(); });
+        return result;
+    }
+    inline int threadCount() const {
+        return (int) threads.size();
+    }
+private:
+    void push(std::function<void()> job);
+    void work();
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<std::function<void()>> jobs;
+    bool stopping = false;
+    std::vector<std::thread> threads;
+};
+
+#endif
@@ -1,4 +1,5 @@
 #include "game.h"
+#include "profiler.h"
 
 const float MAX_HORIZONTAL_VELOCITY = 10.0f;
 const float MAX_VERTICAL_VELOCITY = 20.0f;
@@ -6,6 +7,7 @@ const float PLAYER_JUMP_IMPULSE_AMOUNT = 10.0f;
 const float MOVE_INTERPOLATE_DISTANCE_LIMIT = 0.1f;
 
 World::World() {
+    MemoryScope scope(MEMORY_BEHAVIOR);
     player = makePlayer(this, {0.0f, -5.0f});
     ground = makeGroundType(this, Box{{0.0f, 5.0f}, {20.0f, 10.0f}});
     enemy = makeEnemyClap(this, {5.0f, -5.0f});
@@ -14,8 +16,10 @@ World::World() {
 
 // later replace GLFWwindow* api use with a controller abstraction of some sort
 void World::update(double timeStep, GLFWwindow* window) {
-    for (GameObject* gameObject : gameObjects) {
-        gameObject->update(timeStep, this);
+    PROFILE_ZONE("World::update");
+    MemoryScope scope(MEMORY_BEHAVIOR);
+    for (size_t i = 0; i < components.size(); ++i) {
+        KIND_HANDLERS[components.kinds[i]].update(components.objects[i], timeStep, this);
     }
 
     // player movement
@@ -24,16 +28,19 @@ void World::update(double timeStep, GLFWwindow* window) {
     // applyForce backwards when velocity in a direction is too high
     // setVelocity to the limit when it is above a limit
     b2Vec2 playerMove(0.0f, 0.0f);
-    bool playerJump = glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS;
+    // no window means no input, the player only slows down
+    bool playerJump = window && glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS;
     bool playerSlowDown = false;
-    playerMove.x += (glfwGetKey(window, GLFW_KEY_D) - glfwGetKey(window, GLFW_KEY_A));
+    if (window) {
+        playerMove.x += (glfwGetKey(window, GLFW_KEY_D) - glfwGetKey(window, GLFW_KEY_A));
+    }
     if (playerMove.LengthSquared() > 0) {
         playerMove.x *= 1.0f / playerMove.Length();
         playerMove.y *= 1.0f / playerMove.Length();
     }
 
     // make player slow down if not trying to move
-    if (playerMove.LengthSquared() < 0.00001f && player->onGround && abs(player->rigidBody->GetLinearVelocity().x) > 0) {
+    if (playerMove.LengthSquared() < 0.00001f && player->ground().onGround && abs(player->rigidBody->GetLinearVelocity().x) > 0) {
         float movingDir = player->rigidBody->GetLinearVelocity().x;
         if (movingDir > 0) playerMove.x = -1;
         if (movingDir < 0) playerMove.x = +1;
@@ -41,15 +48,15 @@ void World::update(double timeStep, GLFWwindow* window) {
     }
 
     playerMove *= 1000 / 60.0f;
-    if (player->onGround) {
+    if (player->ground().onGround) {
         playerMove *= 2;
     }
 
     if (playerJump) {
         // check player can jump
-        // std::cout << "Player trying to jump, og: " << player->onGround << std::endl;
+        // std::cout << "Player trying to jump, og: " << player->ground().onGround << std::endl;
 
-        if (player->onGround) {
+        if (player->ground().onGround) {
             b2Vec2 playerJumpImpulse(0, -PLAYER_JUMP_IMPULSE_AMOUNT);
             // now we decide to jump
             if (playerJumpImpulse.LengthSquared() > 0.00001f) {
@@ -59,7 +66,7 @@ void World::update(double timeStep, GLFWwindow* window) {
                 player->rigidBody->SetTransform(player->rigidBody->GetPosition() + b2Vec2(0, -0.1f), player->rigidBody->GetAngle());
             }
         } else {
-            if (player->airTime < 0.5f) {
+            if (player->ground().airTime < 0.5f) {
                 playerMove.y -= 10;
             }
         }
@@ -80,7 +87,7 @@ void World::update(double timeStep, GLFWwindow* window) {
     velocity.y = limitMagnitude(velocity.y, MAX_VERTICAL_VELOCITY);
     player->rigidBody->SetLinearVelocity(velocity);
 
-    std::vector<int> wavesToDelete;
+    ScratchVector<int> wavesToDelete = scratchVector<int>();
     for (int i = 0; i < (int) waves.size(); ++i) {
         Wave& wave = waves[i];
         wave.timer += timeStep;
@@ -93,11 +100,12 @@ void World::update(double timeStep, GLFWwindow* window) {
         waves.erase(waves.begin() + index);
     }
 
-    for (GameObject* obj : gameObjects) {
-        if (obj->rigidBody->IsAwake()) {
-            obj->onGround = false;
-            obj->airTime += timeStep;
-        }
+    resetGroundState(components, (float) timeStep);
+    {
+        PROFILE_ZONE("b2World::Step");
+        box2dWorld.Step(timeStep, 8, 3);
     }
-    box2dWorld.Step(timeStep, 8, 3);
+    syncTransforms(components);
+    updateSpriteFrames(components);
+    updateSpriteBounds(components, objectIndex);
 }